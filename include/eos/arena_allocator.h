@@ -0,0 +1,182 @@
+/**
+ * @author Gracjan Olbinski <gracjan.olbinski@gmail.com>
+ */
+
+
+#ifndef EOS_ARENA_ALLOCATOR_H_
+#define EOS_ARENA_ALLOCATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <new>
+
+namespace eos
+{
+
+/**
+ * Bump allocator over a chain of blocks, each twice the size of the one
+ * before. Deallocation is a no-op; release() or destruction frees every
+ * block at once. Optionally starts from a caller-owned initial buffer,
+ * e.g. one on the stack. Not thread-safe.
+ */
+class monotonic_buffer
+{
+public:
+    explicit monotonic_buffer(std::size_t block_size = 4096)
+    : initial_(nullptr)
+    , initial_size_(0)
+    , current_(nullptr)
+    , end_(nullptr)
+    , blocks_(nullptr)
+    , block_size_(std::max<std::size_t>(block_size, sizeof(block)))
+    , next_size_(block_size_)
+    {
+    }
+
+    monotonic_buffer(void* buffer, std::size_t size)
+    : initial_(static_cast<char*>(buffer))
+    , initial_size_(size)
+    , current_(initial_)
+    , end_(initial_ + size)
+    , blocks_(nullptr)
+    , block_size_(std::max<std::size_t>(size, sizeof(block)))
+    , next_size_(block_size_)
+    {
+    }
+
+    monotonic_buffer(const monotonic_buffer&) = delete;
+    monotonic_buffer& operator=(const monotonic_buffer&) = delete;
+
+    ~monotonic_buffer()
+    {
+        release();
+    }
+
+    void* allocate(std::size_t bytes, std::size_t alignment)
+    {
+        char* first = align(current_, alignment);
+        if ( first == nullptr || first > end_ || static_cast<std::size_t>(end_ - first) < bytes )
+        {
+            add_block(bytes + alignment);
+            first = align(current_, alignment);
+        }
+        current_ = first + bytes;
+        return first;
+    }
+
+    /**
+     * Frees every block and rewinds to the initial buffer; everything
+     * allocated from the buffer becomes invalid.
+     */
+    void release() noexcept
+    {
+        while ( blocks_ != nullptr )
+        {
+            block* next = blocks_->next;
+            ::operator delete(blocks_);
+            blocks_ = next;
+        }
+        current_ = initial_;
+        end_ = initial_ + initial_size_;
+        next_size_ = block_size_;
+    }
+
+private:
+    struct block
+    {
+        block*          next;
+        std::size_t     size;
+    };
+
+    static char* align(char* position, std::size_t alignment) noexcept
+    {
+        if ( position == nullptr )
+        {
+            return nullptr;
+        }
+        std::uintptr_t address = reinterpret_cast<std::uintptr_t>(position);
+        return position + (alignment - address % alignment) % alignment;
+    }
+
+    void add_block(std::size_t minimum)
+    {
+        std::size_t size = std::max(next_size_, minimum + sizeof(block));
+        block* added = static_cast<block*>(::operator new(size));
+        added->next = blocks_;
+        added->size = size;
+        blocks_ = added;
+        current_ = reinterpret_cast<char*>(added + 1);
+        end_ = reinterpret_cast<char*>(added) + size;
+        next_size_ = 2 * size;
+    }
+
+    char*           initial_;
+    std::size_t     initial_size_;
+    char*           current_;
+    char*           end_;
+    block*          blocks_;
+    std::size_t     block_size_;
+    std::size_t     next_size_;
+};  // class monotonic_buffer
+
+/**
+ * Allocator drawing from a monotonic_buffer, which must outlive every
+ * container using it. Like the polymorphic allocators of later standards
+ * it does not propagate on copy, move or swap, so a container stays in the
+ * arena it was built in.
+ */
+template <typename T>
+class arena_allocator
+{
+public:
+    typedef          T                                      value_type;
+
+    explicit arena_allocator(monotonic_buffer& buffer) noexcept
+    : buffer_(&buffer)
+    {
+    }
+
+    template <typename U>
+    arena_allocator(const arena_allocator<U>& other) noexcept
+    : buffer_(other.buffer())
+    {
+    }
+
+    T* allocate(std::size_t n)
+    {
+        if ( n > static_cast<std::size_t>(-1) / sizeof(T) )
+        {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(buffer_->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, std::size_t) noexcept
+    {
+    }
+
+    monotonic_buffer* buffer() const noexcept
+    {
+        return buffer_;
+    }
+
+private:
+    monotonic_buffer*   buffer_;
+};  // class arena_allocator
+
+template <typename T, typename U>
+bool operator==(const arena_allocator<T>& lhs, const arena_allocator<U>& rhs) noexcept
+{
+    return lhs.buffer() == rhs.buffer();
+}
+
+template <typename T, typename U>
+bool operator!=(const arena_allocator<T>& lhs, const arena_allocator<U>& rhs) noexcept
+{
+    return lhs.buffer() != rhs.buffer();
+}
+
+}  // namespace eos
+
+#endif  // EOS_ARENA_ALLOCATOR_H_
@@ -0,0 +1,375 @@
+/**
+ * @author Gracjan Olbinski <gracjan.olbinski@gmail.com>
+ */
+
+
+#ifndef EOS_CONCURRENT_LINEAR_SET_H_
+#define EOS_CONCURRENT_LINEAR_SET_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "eos/linear_set.h"
+#include "eos/detail/platform.h"
+
+namespace eos
+{
+
+/**
+ * linear_set shared between many readers and serialized writers. Readers
+ * pin the current version through a snapshot without taking a lock: they
+ * only write an epoch into a free reader slot, probing from one chosen by
+ * hashing the thread id. When every slot is taken, e.g. by one thread
+ * holding many snapshots, the reader registers an overflow slot under a
+ * mutex instead of waiting for a slot to free up. Writers copy the current
+ * version, apply a batch of changes to the copy and publish it with an
+ * atomic pointer swap. Replaced versions are freed once no reader slot holds
+ * an epoch old enough to still see them.
+ */
+template <
+    typename Key,
+    typename Compare = std::less<Key>,
+    typename Alloc = std::allocator<Key>
+    >
+class concurrent_linear_set
+{
+public:
+    typedef          linear_set<Key, Compare, Alloc>        set_type;
+    typedef typename set_type::key_type                     key_type;
+    typedef typename set_type::value_type                   value_type;
+    typedef typename set_type::key_compare                  key_compare;
+    typedef typename set_type::size_type                    size_type;
+
+private:
+    struct alignas(detail::cache_line_size) reader_slot
+    {
+        std::atomic<std::uint64_t>  epoch;
+    };
+
+    /**
+     * Idle reader slots, one per cache line. operator new only guarantees
+     * fundamental alignment before C++17, so the block is over-allocated and
+     * aligned by hand.
+     */
+    class slot_block
+    {
+    public:
+        explicit slot_block(size_type count)
+        : memory_(new char[count * sizeof(reader_slot) + alignof(reader_slot) - 1])
+        , slots_(nullptr)
+        , count_(count)
+        {
+            void* first = memory_.get();
+            std::size_t space = count * sizeof(reader_slot) + alignof(reader_slot) - 1;
+            slots_ = static_cast<reader_slot*>(std::align(alignof(reader_slot), count * sizeof(reader_slot),
+                                                          first, space));
+            for ( size_type i = 0; i < count; ++i )
+            {
+                new (slots_ + i) reader_slot();
+                slots_[i].epoch.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        reader_slot& operator[](size_type i) const noexcept
+        {
+            return slots_[i];
+        }
+
+        size_type size() const noexcept
+        {
+            return count_;
+        }
+
+    private:
+        std::unique_ptr<char[]>     memory_;
+        reader_slot*                slots_;
+        size_type                   count_;
+    };  // class slot_block
+
+public:
+    /**
+     * Pins one version of the set for as long as it lives.
+     */
+    class snapshot
+    {
+    public:
+        snapshot(snapshot&& other) noexcept
+        : slot_(other.slot_)
+        , set_(other.set_)
+        {
+            other.slot_ = nullptr;
+            other.set_ = nullptr;
+        }
+
+        snapshot(const snapshot&) = delete;
+        snapshot& operator=(const snapshot&) = delete;
+
+        ~snapshot()
+        {
+            if ( slot_ != nullptr )
+            {
+                slot_->epoch.store(0, std::memory_order_release);
+            }
+        }
+
+        const set_type& operator*() const noexcept
+        {
+            return *set_;
+        }
+
+        const set_type* operator->() const noexcept
+        {
+            return set_;
+        }
+
+        const set_type& get() const noexcept
+        {
+            return *set_;
+        }
+
+    private:
+        friend class concurrent_linear_set;
+
+        snapshot(reader_slot* slot, const set_type* set) noexcept
+        : slot_(slot)
+        , set_(set)
+        {
+        }
+
+        reader_slot*        slot_;
+        const set_type*     set_;
+    };  // class snapshot
+
+    explicit concurrent_linear_set(size_type reader_slots = 0,
+                                   const key_compare& comp = key_compare(),
+                                   const Alloc& alloc = Alloc())
+    : slot_count_(( reader_slots != 0 ) ? reader_slots : default_slot_count())
+    , slots_(slot_count_)
+    , current_(new set_type(comp, alloc))
+    , epoch_(1)
+    {
+    }
+
+    explicit concurrent_linear_set(set_type initial, size_type reader_slots = 0)
+    : slot_count_(( reader_slots != 0 ) ? reader_slots : default_slot_count())
+    , slots_(slot_count_)
+    , current_(nullptr)
+    , epoch_(1)
+    {
+        initial.defer_sort(0);
+        current_.store(new set_type(std::move(initial)));
+    }
+
+    concurrent_linear_set(const concurrent_linear_set&) = delete;
+    concurrent_linear_set& operator=(const concurrent_linear_set&) = delete;
+
+    /**
+     * No snapshot may outlive the set.
+     */
+    ~concurrent_linear_set()
+    {
+        delete current_.load();
+        for ( std::size_t i = 0; i < retired_.size(); ++i )
+        {
+            delete retired_[i].first;
+        }
+    }
+
+    snapshot read() const
+    {
+        reader_slot* slot = claim_slot();
+        return snapshot(slot, current_.load());
+    }
+
+    size_type size() const
+    {
+        return read()->size();
+    }
+
+    bool empty() const
+    {
+        return read()->empty();
+    }
+
+    size_type count(const value_type& val) const
+    {
+        return read()->count(val);
+    }
+
+    /**
+     * Copies the current version, lets f modify the copy and publishes it.
+     * Writers are serialized; readers keep using the previous version until
+     * they take a new snapshot.
+     */
+    template <class Function>
+    void update(Function f)
+    {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        std::unique_ptr<set_type> next(new set_type(*current_.load()));
+        f(*next);
+        next->defer_sort(0);
+        publish(next.release());
+    }
+
+    void assign(set_type set)
+    {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        set.defer_sort(0);
+        publish(new set_type(std::move(set)));
+    }
+
+    bool insert(const value_type& val)
+    {
+        bool inserted = false;
+        update([&](set_type& set)
+        {
+            inserted = set.insert(val).second;
+        });
+        return inserted;
+    }
+
+    template <class InputIterator>
+    void insert(InputIterator first, InputIterator last)
+    {
+        update([&](set_type& set)
+        {
+            set.insert(first, last);
+        });
+    }
+
+    size_type erase(const value_type& val)
+    {
+        size_type erased = 0;
+        update([&](set_type& set)
+        {
+            erased = set.erase(val);
+        });
+        return erased;
+    }
+
+    /**
+     * Frees the replaced versions no reader can reach any more; writers call
+     * it after every publish.
+     */
+    void reclaim()
+    {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        reclaim_locked();
+    }
+
+    size_type retired() const
+    {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        return retired_.size();
+    }
+
+private:
+    static size_type default_slot_count()
+    {
+        return 4 * std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    reader_slot* claim_slot() const
+    {
+        static thread_local const std::size_t hash = std::hash<std::thread::id>()(std::this_thread::get_id());
+        for ( size_type n = 0, i = hash % slot_count_; n < slot_count_; ++n, i = ( i + 1 == slot_count_ ) ? 0 : i + 1 )
+        {
+            if ( try_claim(slots_[i]) )
+            {
+                return &slots_[i];
+            }
+        }
+        return claim_overflow_slot();
+    }
+
+    /**
+     * Overflow slots are reused once released and only freed with the set,
+     * so there are never more of them than snapshots held at once.
+     */
+    reader_slot* claim_overflow_slot() const
+    {
+        std::lock_guard<std::mutex> lock(overflow_mutex_);
+        for ( std::size_t i = 0; i < overflow_.size(); ++i )
+        {
+            if ( try_claim(overflow_[i][0]) )
+            {
+                return &overflow_[i][0];
+            }
+        }
+        overflow_.push_back(slot_block(1));
+        overflow_.back()[0].epoch.store(epoch_.load());
+        return &overflow_.back()[0];
+    }
+
+    bool try_claim(reader_slot& slot) const
+    {
+        std::uint64_t idle = 0;
+        return slot.epoch.load(std::memory_order_relaxed) == 0 &&
+               slot.epoch.compare_exchange_strong(idle, epoch_.load());
+    }
+
+    void publish(set_type* next)
+    {
+        const set_type* previous = current_.exchange(next);
+        retired_.push_back(std::make_pair(previous, epoch_.fetch_add(1)));
+        reclaim_locked();
+    }
+
+    void reclaim_locked()
+    {
+        std::uint64_t oldest = epoch_.load();
+        for ( size_type i = 0; i < slot_count_; ++i )
+        {
+            std::uint64_t epoch = slots_[i].epoch.load();
+            if ( epoch != 0 && epoch < oldest )
+            {
+                oldest = epoch;
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(overflow_mutex_);
+            for ( std::size_t i = 0; i < overflow_.size(); ++i )
+            {
+                std::uint64_t epoch = overflow_[i][0].epoch.load();
+                if ( epoch != 0 && epoch < oldest )
+                {
+                    oldest = epoch;
+                }
+            }
+        }
+        std::size_t kept = 0;
+        for ( std::size_t i = 0; i < retired_.size(); ++i )
+        {
+            if ( retired_[i].second < oldest )
+            {
+                delete retired_[i].first;
+            }
+            else
+            {
+                retired_[kept++] = retired_[i];
+            }
+        }
+        retired_.resize(kept);
+    }
+
+    size_type                                                   slot_count_;
+    slot_block                                                  slots_;
+    std::atomic<const set_type*>                                current_;
+    std::atomic<std::uint64_t>                                  epoch_;
+    mutable std::mutex                                          writer_mutex_;
+    mutable std::mutex                                          overflow_mutex_;
+    mutable std::vector<slot_block>                             overflow_;
+    std::vector<std::pair<const set_type*, std::uint64_t> >     retired_;
+};  // class concurrent_linear_set
+
+}  // namespace eos
+
+#endif  // EOS_CONCURRENT_LINEAR_SET_H_
@@ -0,0 +1,171 @@
+/**
+ * @author Gracjan Olbinski <gracjan.olbinski@gmail.com>
+ */
+
+
+#ifndef EOS_DETAIL_ALGORITHM_H_
+#define EOS_DETAIL_ALGORITHM_H_
+
+#include <cstddef>
+#include <algorithm>
+#include <iterator>
+
+namespace eos
+{
+namespace detail
+{
+
+template <class RandomIt, class T, class Compare>
+RandomIt gallop_lower_bound(RandomIt first, RandomIt last, const T& val, Compare comp)
+{
+    typedef typename std::iterator_traits<RandomIt>::difference_type difference_type;
+    difference_type size = last - first;
+    difference_type lo = 0, hi = 0, step = 1;
+    while ( hi < size && comp(first[hi], val) )
+    {
+        lo = hi + 1;
+        hi += step;
+        step *= 2;
+    }
+    return std::lower_bound(first + lo, first + std::min(hi, size), val, comp);
+}
+
+template <class RandomIt, class T, class Compare>
+RandomIt gallop_lower_bound_backward(RandomIt first, RandomIt last, const T& val, Compare comp)
+{
+    typedef typename std::iterator_traits<RandomIt>::difference_type difference_type;
+    difference_type lo = last - first - 1, hi = last - first, step = 1;
+    while ( lo >= 0 && !comp(first[lo], val) )
+    {
+        hi = lo;
+        lo -= step;
+        step *= 2;
+    }
+    return std::lower_bound(first + std::max(lo + 1, difference_type(0)), first + hi, val, comp);
+}
+
+inline bool should_gallop(std::size_t size, std::size_t other_size)
+{
+    return size / 8 > other_size;
+}
+
+template <class RandomIt, class T, class Compare>
+RandomIt skip_less(RandomIt first, RandomIt last, const T& val, Compare comp, bool gallop,
+                   std::random_access_iterator_tag)
+{
+    return gallop ? gallop_lower_bound(first, last, val, comp) : ++first;
+}
+
+template <class ForwardIt, class T, class Compare>
+ForwardIt skip_less(ForwardIt first, ForwardIt, const T&, Compare, bool,
+                    std::forward_iterator_tag)
+{
+    return ++first;
+}
+
+template <class ForwardIt, class T, class Compare>
+ForwardIt skip_less(ForwardIt first, ForwardIt last, const T& val, Compare comp, bool gallop)
+{
+    return skip_less(first, last, val, comp, gallop,
+                     typename std::iterator_traits<ForwardIt>::iterator_category());
+}
+
+template <class RandomIt1, class RandomIt2, class OutputIt, class Compare>
+OutputIt gallop_set_intersection(RandomIt1 first1, RandomIt1 last1,
+                                 RandomIt2 first2, RandomIt2 last2,
+                                 OutputIt out, Compare comp)
+{
+    bool gallop1 = should_gallop(last1 - first1, last2 - first2);
+    bool gallop2 = should_gallop(last2 - first2, last1 - first1);
+    while ( first1 != last1 && first2 != last2 )
+    {
+        if ( comp(*first1, *first2) )
+        {
+            first1 = gallop1 ? gallop_lower_bound(first1, last1, *first2, comp) : first1 + 1;
+        }
+        else if ( comp(*first2, *first1) )
+        {
+            first2 = gallop2 ? gallop_lower_bound(first2, last2, *first1, comp) : first2 + 1;
+        }
+        else
+        {
+            *out++ = *first1;
+            ++first1;
+            ++first2;
+        }
+    }
+    return out;
+}
+
+template <class RandomIt1, class RandomIt2, class OutputIt, class Compare>
+OutputIt gallop_set_difference(RandomIt1 first1, RandomIt1 last1,
+                               RandomIt2 first2, RandomIt2 last2,
+                               OutputIt out, Compare comp)
+{
+    bool gallop1 = should_gallop(last1 - first1, last2 - first2);
+    bool gallop2 = should_gallop(last2 - first2, last1 - first1);
+    while ( first1 != last1 && first2 != last2 )
+    {
+        if ( comp(*first1, *first2) )
+        {
+            RandomIt1 next = gallop1 ? gallop_lower_bound(first1, last1, *first2, comp) : first1 + 1;
+            out = std::copy(first1, next, out);
+            first1 = next;
+        }
+        else if ( comp(*first2, *first1) )
+        {
+            first2 = gallop2 ? gallop_lower_bound(first2, last2, *first1, comp) : first2 + 1;
+        }
+        else
+        {
+            ++first1;
+            ++first2;
+        }
+    }
+    return std::copy(first1, last1, out);
+}
+
+/**
+ * Sorts [first, last) stably unless it is already sorted and moves the first
+ * of every run of equivalent elements to the front; returns the new end.
+ */
+template <class RandomIt, class Compare>
+RandomIt sort_unique(RandomIt first, RandomIt last, Compare comp)
+{
+    typedef typename std::iterator_traits<RandomIt>::value_type value_type;
+    if ( !std::is_sorted(first, last, comp) )
+    {
+        std::stable_sort(first, last, comp);
+    }
+    return std::unique(first, last,
+                       [&comp](const value_type& lhs, const value_type& rhs)
+                       {
+                           return !comp(lhs, rhs);
+                       });
+}
+
+/**
+ * Merges the sorted unique ranges [first, middle) and [middle, last) and
+ * drops the elements of the second range equivalent to one of the first;
+ * returns the new end.
+ */
+template <class RandomIt, class Compare>
+RandomIt merge_unique(RandomIt first, RandomIt middle, RandomIt last, Compare comp)
+{
+    typedef typename std::iterator_traits<RandomIt>::value_type value_type;
+    if ( first == middle || middle == last || comp(*(middle - 1), *middle) )
+    {
+        return last;
+    }
+    std::inplace_merge(first, middle, last, comp);
+    return std::unique(first, last,
+                       [&comp](const value_type& lhs, const value_type& rhs)
+                       {
+                           return !comp(lhs, rhs);
+                       });
+}
+
+}  // namespace detail
+}  // namespace eos
+
+#endif  // EOS_DETAIL_ALGORITHM_H_
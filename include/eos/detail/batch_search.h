@@ -0,0 +1,71 @@
+/**
+ * @author Gracjan Olbinski <gracjan.olbinski@gmail.com>
+ */
+
+
+#ifndef EOS_DETAIL_BATCH_SEARCH_H_
+#define EOS_DETAIL_BATCH_SEARCH_H_
+
+#include <cstddef>
+#include <iterator>
+
+#include "eos/detail/platform.h"
+
+namespace eos
+{
+namespace detail
+{
+
+const std::size_t batch_search_group = 16;
+
+/**
+ * Runs lower_bound for every query in [queries_first, queries_last) and
+ * calls f(query, result) in query order. Searches advance in groups in
+ * lockstep, so the probes of one step are independent loads; the next
+ * probe of every search is prefetched before the step that needs it.
+ */
+template <class RandomIt, class ForwardIterator, class Compare, class Function>
+void batch_lower_bound(RandomIt first, RandomIt last,
+                       ForwardIterator queries_first, ForwardIterator queries_last,
+                       Compare comp, Function f)
+{
+    std::size_t size = last - first;
+    ForwardIterator queries[batch_search_group];
+    std::size_t bases[batch_search_group];
+    while ( queries_first != queries_last )
+    {
+        std::size_t count = 0;
+        for ( ; count < batch_search_group && queries_first != queries_last; ++count, ++queries_first )
+        {
+            queries[count] = queries_first;
+            bases[count] = 0;
+        }
+        if ( size == 0 )
+        {
+            for ( std::size_t i = 0; i < count; ++i )
+            {
+                f(*queries[i], last);
+            }
+            continue;
+        }
+        for ( std::size_t remaining = size; remaining > 1; )
+        {
+            std::size_t half = remaining / 2;
+            remaining -= half;
+            for ( std::size_t i = 0; i < count; ++i )
+            {
+                bases[i] += comp(first[bases[i] + half], *queries[i]) ? half : 0;
+                EOS_PREFETCH(&first[bases[i] + remaining / 2]);
+            }
+        }
+        for ( std::size_t i = 0; i < count; ++i )
+        {
+            f(*queries[i], first + bases[i] + ( comp(first[bases[i]], *queries[i]) ? 1 : 0 ));
+        }
+    }
+}
+
+}  // namespace detail
+}  // namespace eos
+
+#endif  // EOS_DETAIL_BATCH_SEARCH_H_
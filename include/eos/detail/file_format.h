@@ -0,0 +1,224 @@
+/**
+ * @author Gracjan Olbinski <gracjan.olbinski@gmail.com>
+ */
+
+
+#ifndef EOS_DETAIL_FILE_FORMAT_H_
+#define EOS_DETAIL_FILE_FORMAT_H_
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace eos
+{
+namespace detail
+{
+
+/**
+ * On-disk layout of a saved set, all fields in the writer's byte order:
+ *
+ *   offset  size  field
+ *        0     8  magic "EOSLSET\0"
+ *        8     4  format version (1)
+ *       12     4  sizeof(Key)
+ *       16     4  key kind: 0 other, 1 unsigned integer, 2 signed integer, 3 floating point
+ *       20     4  endianness marker 0x01020304
+ *       24     8  number of keys
+ *       32     8  FNV-1a 64 checksum of the key bytes
+ *       40    24  zero padding
+ *       64     -  keys, sorted and unique, count * sizeof(Key) bytes
+ *
+ * The 64-byte header keeps the keys cache-line aligned inside a mapping.
+ * Readers reject files whose marker reads back byte-swapped rather than
+ * converting them.
+ */
+struct file_header
+{
+    char            magic[8];
+    std::uint32_t   version;
+    std::uint32_t   key_size;
+    std::uint32_t   key_kind;
+    std::uint32_t   endianness;
+    std::uint64_t   count;
+    std::uint64_t   checksum;
+    unsigned char   padding[24];
+};
+
+static_assert(sizeof(file_header) == 64, "file_header must stay 64 bytes");
+
+static const char           file_magic[8]   = { 'E', 'O', 'S', 'L', 'S', 'E', 'T', '\0' };
+static const std::uint32_t  file_version    = 1;
+static const std::uint32_t  file_endianness = 0x01020304;
+
+template <class T>
+std::uint32_t file_key_kind()
+{
+    return std::is_floating_point<T>::value ? 3
+         : std::is_integral<T>::value ? ( std::is_signed<T>::value ? 2 : 1 )
+         : 0;
+}
+
+inline std::uint64_t fnv1a64(const void* data, std::size_t size)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    std::uint64_t hash = 14695981039346656037ULL;
+    for ( std::size_t i = 0; i < size; ++i )
+    {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+template <class T>
+file_header make_file_header(const T* keys, std::size_t count)
+{
+    file_header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, file_magic, sizeof(file_magic));
+    header.version = file_version;
+    header.key_size = sizeof(T);
+    header.key_kind = file_key_kind<T>();
+    header.endianness = file_endianness;
+    header.count = count;
+    header.checksum = fnv1a64(keys, count * sizeof(T));
+    return header;
+}
+
+/**
+ * Throws std::runtime_error unless header describes `size` bytes of T keys
+ * written on a machine with the same byte order.
+ */
+template <class T>
+void check_file_header(const file_header& header, std::size_t size, const std::string& path)
+{
+    if ( size < sizeof(file_header) || std::memcmp(header.magic, file_magic, sizeof(file_magic)) != 0 )
+    {
+        throw std::runtime_error("eos: not a linear_set file: " + path);
+    }
+    if ( header.version != file_version )
+    {
+        throw std::runtime_error("eos: unsupported linear_set file version: " + path);
+    }
+    if ( header.endianness != file_endianness )
+    {
+        throw std::runtime_error("eos: linear_set file has foreign byte order: " + path);
+    }
+    if ( header.key_size != sizeof(T) || header.key_kind != file_key_kind<T>() )
+    {
+        throw std::runtime_error("eos: linear_set file key type mismatch: " + path);
+    }
+    if ( header.count > (size - sizeof(file_header)) / sizeof(T) ||
+         sizeof(file_header) + header.count * sizeof(T) != size )
+    {
+        throw std::runtime_error("eos: linear_set file size does not match its header: " + path);
+    }
+}
+
+inline bool write_all(int fd, const void* data, std::size_t size)
+{
+    const char* bytes = static_cast<const char*>(data);
+    while ( size != 0 )
+    {
+        ssize_t written = ::write(fd, bytes, size);
+        if ( written < 0 )
+        {
+            if ( errno == EINTR )
+            {
+                continue;
+            }
+            return false;
+        }
+        bytes += written;
+        size -= written;
+    }
+    return true;
+}
+
+inline void sync_directory_of(const std::string& path)
+{
+    std::string::size_type slash = path.rfind('/');
+    std::string directory = ( slash == std::string::npos ) ? "." : ( slash == 0 ) ? "/" : path.substr(0, slash);
+    int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if ( fd < 0 )
+    {
+        throw std::system_error(errno, std::generic_category(), "eos: cannot open directory " + directory);
+    }
+    int result = ::fsync(fd);
+    int error = errno;
+    ::close(fd);
+    if ( result != 0 )
+    {
+        throw std::system_error(error, std::generic_category(), "eos: cannot sync directory " + directory);
+    }
+}
+
+/**
+ * Creates a sibling of path named after the process and a per-process
+ * counter with O_EXCL, retrying on collisions as mkstemp does. The mode is
+ * 0666 filtered by the umask, as for any other file the process creates.
+ */
+inline int create_temporary(const std::string& path, std::string& temporary)
+{
+    static std::atomic<unsigned> counter(0);
+    for ( ;; )
+    {
+        temporary = path + "." + std::to_string(::getpid()) + "." + std::to_string(counter++) + ".tmp";
+        int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+        if ( fd >= 0 || errno != EEXIST )
+        {
+            return fd;
+        }
+    }
+}
+
+/**
+ * Writes header and keys to a uniquely named sibling temporary file, syncs
+ * it and renames it over path, then syncs the directory. Concurrent savers
+ * never share a temporary, processes that still map the old file keep a
+ * consistent view, and a crash leaves either the old or the new file.
+ */
+template <class T>
+void write_sorted_file(const std::string& path, const T* keys, std::size_t count)
+{
+    std::string temporary;
+    int fd = create_temporary(path, temporary);
+    if ( fd < 0 )
+    {
+        throw std::system_error(errno, std::generic_category(), "eos: cannot create " + temporary);
+    }
+    file_header header = make_file_header(keys, count);
+    bool written = write_all(fd, &header, sizeof(header)) &&
+                   write_all(fd, keys, count * sizeof(T)) &&
+                   ::fsync(fd) == 0;
+    int error = errno;
+    if ( ::close(fd) != 0 && written )
+    {
+        written = false;
+        error = errno;
+    }
+    if ( !written || std::rename(temporary.c_str(), path.c_str()) != 0 )
+    {
+        error = written ? errno : error;
+        ::unlink(temporary.c_str());
+        throw std::system_error(error, std::generic_category(), "eos: cannot write " + path);
+    }
+    sync_directory_of(path);
+}
+
+}  // namespace detail
+}  // namespace eos
+
+#endif  // EOS_DETAIL_FILE_FORMAT_H_
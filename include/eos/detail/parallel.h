@@ -0,0 +1,211 @@
+/**
+ * @author Gracjan Olbinski <gracjan.olbinski@gmail.com>
+ */
+
+
+#ifndef EOS_DETAIL_PARALLEL_H_
+#define EOS_DETAIL_PARALLEL_H_
+
+#include <cstddef>
+#include <vector>
+#include <thread>
+#include <memory>
+#include <iterator>
+#include <algorithm>
+#include <exception>
+
+namespace eos
+{
+namespace detail
+{
+
+template <class Function>
+void parallel_for(std::size_t count, Function f)
+{
+    std::vector<std::exception_ptr> errors(count);
+    std::vector<std::thread> workers;
+    workers.reserve(count);
+    try
+    {
+        for ( std::size_t i = 1; i < count; ++i )
+        {
+            workers.push_back(std::thread([&f, &errors, i]
+            {
+                try
+                {
+                    f(i);
+                }
+                catch ( ... )
+                {
+                    errors[i] = std::current_exception();
+                }
+            }));
+        }
+        f(0);
+    }
+    catch ( ... )
+    {
+        errors[0] = std::current_exception();
+    }
+    for ( std::size_t i = 0; i < workers.size(); ++i )
+    {
+        workers[i].join();
+    }
+    for ( std::size_t i = 0; i < count; ++i )
+    {
+        if ( errors[i] )
+        {
+            std::rethrow_exception(errors[i]);
+        }
+    }
+}
+
+/**
+ * Sorts storage and drops equivalent elements using `threads` workers:
+ * chunks are sorted independently, sampled splitters cut every chunk into
+ * per-worker partitions which never split a run of equivalent keys, and
+ * each worker k-way merges and dedupes its partition into a scratch buffer.
+ * Equivalent keys keep their first occurrence in the input, like the
+ * sequential build.
+ */
+template <class Storage, class Compare>
+void parallel_sort_unique(Storage& storage, std::size_t threads, Compare comp)
+{
+    typedef typename Storage::iterator                              iterator;
+    typedef typename Storage::value_type                            value_type;
+    typedef typename Storage::allocator_type                        allocator_type;
+    typedef std::allocator_traits<allocator_type>                   alloc_traits;
+    typedef std::pair<iterator, iterator>                           piece;
+
+    const std::size_t size = storage.size();
+    iterator base = storage.begin();
+
+    std::vector<iterator> chunks(threads + 1);
+    for ( std::size_t i = 0; i <= threads; ++i )
+    {
+        chunks[i] = base + size * i / threads;
+    }
+    parallel_for(threads, [&](std::size_t i)
+    {
+        if ( !std::is_sorted(chunks[i], chunks[i + 1], comp) )
+        {
+            std::stable_sort(chunks[i], chunks[i + 1], comp);
+        }
+    });
+
+    std::vector<value_type> samples;
+    samples.reserve(threads * threads);
+    for ( std::size_t i = 0; i < threads; ++i )
+    {
+        std::size_t length = chunks[i + 1] - chunks[i];
+        for ( std::size_t j = 0; j < threads && j < length; ++j )
+        {
+            samples.push_back(chunks[i][length * j / threads]);
+        }
+    }
+    std::sort(samples.begin(), samples.end(), comp);
+
+    std::vector<std::vector<iterator> > cuts(threads, std::vector<iterator>(threads + 1));
+    for ( std::size_t i = 0; i < threads; ++i )
+    {
+        cuts[i][0] = chunks[i];
+        cuts[i][threads] = chunks[i + 1];
+        for ( std::size_t j = 1; j < threads; ++j )
+        {
+            cuts[i][j] = std::lower_bound(cuts[i][j - 1], chunks[i + 1],
+                                          samples[samples.size() * j / threads], comp);
+        }
+    }
+
+    std::vector<std::size_t> offsets(threads + 1, 0);
+    for ( std::size_t j = 0; j < threads; ++j )
+    {
+        offsets[j + 1] = offsets[j];
+        for ( std::size_t i = 0; i < threads; ++i )
+        {
+            offsets[j + 1] += cuts[i][j + 1] - cuts[i][j];
+        }
+    }
+
+    allocator_type alloc = storage.get_allocator();
+    value_type* buffer = alloc_traits::allocate(alloc, size);
+    std::vector<std::size_t> produced(threads, 0);
+    try
+    {
+        parallel_for(threads, [&](std::size_t j)
+        {
+            std::vector<piece> heap;
+            for ( std::size_t i = 0; i < threads; ++i )
+            {
+                if ( cuts[i][j] != cuts[i][j + 1] )
+                {
+                    heap.push_back(piece(cuts[i][j], cuts[i][j + 1]));
+                }
+            }
+            auto later = [&comp](const piece& lhs, const piece& rhs)
+            {
+                return comp(*rhs.first, *lhs.first) ||
+                       ( !comp(*lhs.first, *rhs.first) && rhs.first < lhs.first );
+            };
+            std::make_heap(heap.begin(), heap.end(), later);
+            value_type* out = buffer + offsets[j];
+            while ( !heap.empty() )
+            {
+                std::pop_heap(heap.begin(), heap.end(), later);
+                piece& top = heap.back();
+                if ( produced[j] == 0 || comp(out[produced[j] - 1], *top.first) )
+                {
+                    alloc_traits::construct(alloc, out + produced[j], std::move(*top.first));
+                    ++produced[j];
+                }
+                if ( ++top.first == top.second )
+                {
+                    heap.pop_back();
+                }
+                else
+                {
+                    std::push_heap(heap.begin(), heap.end(), later);
+                }
+            }
+        });
+
+        storage.clear();
+        std::size_t total = 0;
+        for ( std::size_t j = 0; j < threads; ++j )
+        {
+            total += produced[j];
+        }
+        storage.reserve(total);
+        for ( std::size_t j = 0; j < threads; ++j )
+        {
+            storage.insert(storage.end(),
+                           std::make_move_iterator(buffer + offsets[j]),
+                           std::make_move_iterator(buffer + offsets[j] + produced[j]));
+        }
+    }
+    catch ( ... )
+    {
+        for ( std::size_t j = 0; j < threads; ++j )
+        {
+            for ( std::size_t k = 0; k < produced[j]; ++k )
+            {
+                alloc_traits::destroy(alloc, buffer + offsets[j] + k);
+            }
+        }
+        alloc_traits::deallocate(alloc, buffer, size);
+        throw;
+    }
+    for ( std::size_t j = 0; j < threads; ++j )
+    {
+        for ( std::size_t k = 0; k < produced[j]; ++k )
+        {
+            alloc_traits::destroy(alloc, buffer + offsets[j] + k);
+        }
+    }
+    alloc_traits::deallocate(alloc, buffer, size);
+}
+
+}  // namespace detail
+}  // namespace eos
+
+#endif  // EOS_DETAIL_PARALLEL_H_
@@ -0,0 +1,126 @@
+/**
+ * @author Gracjan Olbinski <gracjan.olbinski@gmail.com>
+ */
+
+
+#ifndef EOS_DETAIL_PLATFORM_H_
+#define EOS_DETAIL_PLATFORM_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define EOS_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define EOS_PREFETCH(address) ((void)(address))
+#endif
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__SSE2__)
+#define EOS_HAVE_SSE2 1
+#if defined(__x86_64__) || defined(__i386__)
+#define EOS_HAVE_AVX2_DISPATCH 1
+#endif
+#endif
+
+namespace eos
+{
+namespace detail
+{
+
+/**
+ * Alignment that keeps independently written data on separate cache lines.
+ */
+const std::size_t cache_line_size = 64;
+
+inline unsigned count_trailing_ones(std::size_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return ( ~value == 0 ) ? sizeof(value) * 8 : __builtin_ctzll(~static_cast<unsigned long long>(value));
+#else
+    unsigned count = 0;
+    for ( ; value & 1; value >>= 1 )
+    {
+        ++count;
+    }
+    return count;
+#endif
+}
+
+inline unsigned popcount64(std::uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(value);
+#else
+    unsigned count = 0;
+    for ( ; value != 0; value &= value - 1 )
+    {
+        ++count;
+    }
+    return count;
+#endif
+}
+
+inline unsigned count_trailing_zeros64(std::uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return ( value == 0 ) ? 64 : __builtin_ctzll(value);
+#else
+    unsigned count = 0;
+    for ( ; count < 64 && (value & 1) == 0; value >>= 1 )
+    {
+        ++count;
+    }
+    return count;
+#endif
+}
+
+inline unsigned count_leading_zeros64(std::uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return ( value == 0 ) ? 64 : __builtin_clzll(value);
+#else
+    unsigned count = 0;
+    for ( std::uint64_t bit = std::uint64_t(1) << 63; bit != 0 && (value & bit) == 0; bit >>= 1 )
+    {
+        ++count;
+    }
+    return count;
+#endif
+}
+
+/**
+ * Position of the rank-th (0-based) set bit of value, which must have more
+ * than rank bits set.
+ */
+inline unsigned select64(std::uint64_t value, unsigned rank)
+{
+    unsigned base = 0;
+    for ( unsigned width = 32; width >= 8; width /= 2 )
+    {
+        unsigned low = popcount64(value & ((std::uint64_t(1) << width) - 1));
+        if ( rank >= low )
+        {
+            rank -= low;
+            value >>= width;
+            base += width;
+        }
+    }
+    for ( ; rank != 0; --rank )
+    {
+        value &= value - 1;
+    }
+    return base + count_trailing_zeros64(value);
+}
+
+#if defined(EOS_HAVE_AVX2_DISPATCH)
+inline bool has_avx2()
+{
+    static const bool result = (__builtin_cpu_init(), __builtin_cpu_supports("avx2") != 0);
+    return result;
+}
+#endif
+
+}  // namespace detail
+}  // namespace eos
+
+#endif  // EOS_DETAIL_PLATFORM_H_
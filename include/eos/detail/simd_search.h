@@ -0,0 +1,279 @@
+/**
+ * @author Gracjan Olbinski <gracjan.olbinski@gmail.com>
+ */
+
+
+#ifndef EOS_DETAIL_SIMD_SEARCH_H_
+#define EOS_DETAIL_SIMD_SEARCH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+
+#include "eos/detail/platform.h"
+
+#if defined(EOS_HAVE_SSE2)
+#include <immintrin.h>
+#endif
+
+namespace eos
+{
+namespace detail
+{
+
+enum simd_kind
+{
+    simd_none,
+    simd_signed32,
+    simd_unsigned32,
+    simd_signed64,
+    simd_unsigned64,
+    simd_float32,
+    simd_float64
+};
+
+template <class T>
+struct simd_kind_of
+: std::integral_constant<simd_kind,
+      std::is_floating_point<T>::value
+          ? ( sizeof(T) == 4 ? simd_float32 : sizeof(T) == 8 ? simd_float64 : simd_none )
+    : std::is_integral<T>::value && !std::is_same<T, bool>::value
+          ? ( sizeof(T) == 4 ? ( std::is_signed<T>::value ? simd_signed32 : simd_unsigned32 )
+            : sizeof(T) == 8 ? ( std::is_signed<T>::value ? simd_signed64 : simd_unsigned64 )
+            : simd_none )
+    : simd_none>
+{
+};
+
+template <class T, class Compare>
+struct is_simd_searchable
+: std::integral_constant<bool,
+      simd_kind_of<T>::value != simd_none && std::is_same<Compare, std::less<T> >::value>
+{
+};
+
+template <class T>
+std::size_t count_less_scalar(const T* first, std::size_t size, T key)
+{
+    std::size_t count = 0;
+    for ( std::size_t i = 0; i < size; ++i )
+    {
+        count += static_cast<std::size_t>(first[i] < key);
+    }
+    return count;
+}
+
+template <simd_kind Kind>
+struct simd_counter
+{
+    template <class T>
+    static std::size_t sse2(const T* first, std::size_t size, T key)
+    {
+        return count_less_scalar(first, size, key);
+    }
+
+    template <class T>
+    static std::size_t avx2(const T* first, std::size_t size, T key)
+    {
+        return count_less_scalar(first, size, key);
+    }
+};
+
+#if defined(EOS_HAVE_SSE2)
+template <bool Unsigned>
+struct int32_counter
+{
+    template <class T>
+    static std::size_t sse2(const T* first, std::size_t size, T key)
+    {
+        const __m128i bias = _mm_set1_epi32(Unsigned ? INT32_MIN : 0);
+        const __m128i needle = _mm_xor_si128(_mm_set1_epi32(static_cast<std::int32_t>(key)), bias);
+        std::size_t count = 0, i = 0;
+        for ( ; i + 4 <= size; i += 4 )
+        {
+            __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i));
+            __m128i less = _mm_cmplt_epi32(_mm_xor_si128(values, bias), needle);
+            count += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(less)));
+        }
+        return count + count_less_scalar(first + i, size - i, key);
+    }
+
+#if defined(EOS_HAVE_AVX2_DISPATCH)
+    template <class T>
+    __attribute__((target("avx2")))
+    static std::size_t avx2(const T* first, std::size_t size, T key)
+    {
+        const __m256i bias = _mm256_set1_epi32(Unsigned ? INT32_MIN : 0);
+        const __m256i needle = _mm256_xor_si256(_mm256_set1_epi32(static_cast<std::int32_t>(key)), bias);
+        std::size_t count = 0, i = 0;
+        for ( ; i + 8 <= size; i += 8 )
+        {
+            __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + i));
+            __m256i less = _mm256_cmpgt_epi32(needle, _mm256_xor_si256(values, bias));
+            count += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(less)));
+        }
+        return count + count_less_scalar(first + i, size - i, key);
+    }
+#endif
+};
+
+template <bool Unsigned>
+struct int64_counter
+{
+    template <class T>
+    static std::size_t sse2(const T* first, std::size_t size, T key)
+    {
+        return count_less_scalar(first, size, key);
+    }
+
+#if defined(EOS_HAVE_AVX2_DISPATCH)
+    template <class T>
+    __attribute__((target("avx2")))
+    static std::size_t avx2(const T* first, std::size_t size, T key)
+    {
+        const __m256i bias = _mm256_set1_epi64x(Unsigned ? INT64_MIN : 0);
+        const __m256i needle = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<long long>(key)), bias);
+        std::size_t count = 0, i = 0;
+        for ( ; i + 4 <= size; i += 4 )
+        {
+            __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + i));
+            __m256i less = _mm256_cmpgt_epi64(needle, _mm256_xor_si256(values, bias));
+            count += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(less)));
+        }
+        return count + count_less_scalar(first + i, size - i, key);
+    }
+#endif
+};
+
+struct float32_counter
+{
+    template <class T>
+    static std::size_t sse2(const T* first, std::size_t size, T key)
+    {
+        const __m128 needle = _mm_set1_ps(key);
+        std::size_t count = 0, i = 0;
+        for ( ; i + 4 <= size; i += 4 )
+        {
+            __m128 values = _mm_loadu_ps(first + i);
+            count += __builtin_popcount(_mm_movemask_ps(_mm_cmplt_ps(values, needle)));
+        }
+        return count + count_less_scalar(first + i, size - i, key);
+    }
+
+#if defined(EOS_HAVE_AVX2_DISPATCH)
+    template <class T>
+    __attribute__((target("avx2")))
+    static std::size_t avx2(const T* first, std::size_t size, T key)
+    {
+        const __m256 needle = _mm256_set1_ps(key);
+        std::size_t count = 0, i = 0;
+        for ( ; i + 8 <= size; i += 8 )
+        {
+            __m256 values = _mm256_loadu_ps(first + i);
+            count += __builtin_popcount(_mm256_movemask_ps(_mm256_cmp_ps(values, needle, _CMP_LT_OQ)));
+        }
+        return count + count_less_scalar(first + i, size - i, key);
+    }
+#endif
+};
+
+struct float64_counter
+{
+    template <class T>
+    static std::size_t sse2(const T* first, std::size_t size, T key)
+    {
+        const __m128d needle = _mm_set1_pd(key);
+        std::size_t count = 0, i = 0;
+        for ( ; i + 2 <= size; i += 2 )
+        {
+            __m128d values = _mm_loadu_pd(first + i);
+            count += __builtin_popcount(_mm_movemask_pd(_mm_cmplt_pd(values, needle)));
+        }
+        return count + count_less_scalar(first + i, size - i, key);
+    }
+
+#if defined(EOS_HAVE_AVX2_DISPATCH)
+    template <class T>
+    __attribute__((target("avx2")))
+    static std::size_t avx2(const T* first, std::size_t size, T key)
+    {
+        const __m256d needle = _mm256_set1_pd(key);
+        std::size_t count = 0, i = 0;
+        for ( ; i + 4 <= size; i += 4 )
+        {
+            __m256d values = _mm256_loadu_pd(first + i);
+            count += __builtin_popcount(_mm256_movemask_pd(_mm256_cmp_pd(values, needle, _CMP_LT_OQ)));
+        }
+        return count + count_less_scalar(first + i, size - i, key);
+    }
+#endif
+};
+
+template <> struct simd_counter<simd_signed32>   : int32_counter<false> {};
+template <> struct simd_counter<simd_unsigned32> : int32_counter<true>  {};
+template <> struct simd_counter<simd_signed64>   : int64_counter<false> {};
+template <> struct simd_counter<simd_unsigned64> : int64_counter<true>  {};
+template <> struct simd_counter<simd_float32>    : float32_counter      {};
+template <> struct simd_counter<simd_float64>    : float64_counter      {};
+#endif
+
+template <class T>
+std::size_t count_less(const T* first, std::size_t size, T key)
+{
+    typedef simd_counter<simd_kind_of<T>::value> counter;
+#if defined(EOS_HAVE_AVX2_DISPATCH)
+    if ( has_avx2() )
+    {
+        return counter::avx2(first, size, key);
+    }
+#endif
+    return counter::sse2(first, size, key);
+}
+
+template <class T>
+std::size_t simd_lower_bound(const T* first, std::size_t size, T key)
+{
+    const std::size_t window = 256 / sizeof(T);
+    const T* base = first;
+    while ( size > window )
+    {
+        std::size_t half = size / 2;
+        base = ( base[half] < key ) ? base + half : base;
+        size -= half;
+    }
+    return (base - first) + count_less(base, size, key);
+}
+
+template <class RandomIt, class T, class Compare>
+RandomIt fast_lower_bound(RandomIt first, RandomIt last, const T& val, Compare comp, std::false_type)
+{
+    return std::lower_bound(first, last, val, comp);
+}
+
+template <class RandomIt, class T, class Compare>
+RandomIt fast_lower_bound(RandomIt first, RandomIt last, const T& val, Compare, std::true_type)
+{
+    if ( first == last )
+    {
+        return last;
+    }
+    return first + simd_lower_bound(&*first, last - first, val);
+}
+
+template <class RandomIt, class T, class Compare>
+RandomIt fast_lower_bound(RandomIt first, RandomIt last, const T& val, Compare comp)
+{
+    typedef typename std::iterator_traits<RandomIt>::value_type value_type;
+    return fast_lower_bound(first, last, val, comp,
+                            std::integral_constant<bool,
+                                is_simd_searchable<value_type, Compare>::value &&
+                                std::is_same<T, value_type>::value>());
+}
+
+}  // namespace detail
+}  // namespace eos
+
+#endif  // EOS_DETAIL_SIMD_SEARCH_H_
@@ -0,0 +1,303 @@
+/**
+ * @author Gracjan Olbinski <gracjan.olbinski@gmail.com>
+ */
+
+
+#ifndef EOS_DETAIL_STATIC_SEARCH_TREE_H_
+#define EOS_DETAIL_STATIC_SEARCH_TREE_H_
+
+#include <cstddef>
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "eos/detail/simd_search.h"
+
+namespace eos
+{
+namespace detail
+{
+
+/**
+ * Implicit 16-ary B+ tree of separators over a sorted array that stays in
+ * place. The bottom level holds the last key of every block of 16 keys,
+ * each level above the last entry of every group of 16 below, so a lookup
+ * is one count_less over a node per level plus one over a block of keys.
+ * The tree keeps no pointer to the keys; the caller passes the array it
+ * was built from.
+ */
+template <class T, class Alloc = std::allocator<T> >
+class static_search_tree
+{
+    typedef typename std::allocator_traits<Alloc>::template rebind_alloc<T> separator_allocator;
+public:
+    static const std::size_t node_size = 16;
+    static const std::size_t max_levels = 16;
+
+    explicit static_search_tree(const Alloc& alloc = Alloc())
+    : separators_(separator_allocator(alloc))
+    , offsets_()
+    , sizes_()
+    , size_(0)
+    , levels_(0)
+    , valid_(false)
+    {
+    }
+
+    static_search_tree(const static_search_tree& other, const Alloc& alloc)
+    : separators_(other.separators_, separator_allocator(alloc))
+    , offsets_()
+    , sizes_()
+    , size_(other.size_)
+    , levels_(other.levels_)
+    , valid_(other.valid_)
+    {
+        std::copy(other.offsets_, other.offsets_ + max_levels, offsets_);
+        std::copy(other.sizes_, other.sizes_ + max_levels, sizes_);
+    }
+
+    Alloc get_allocator() const
+    {
+        return Alloc(separators_.get_allocator());
+    }
+
+    bool valid() const noexcept
+    {
+        return valid_;
+    }
+
+    void invalidate() noexcept
+    {
+        valid_ = false;
+    }
+
+    void build(const T* keys, std::size_t size)
+    {
+        std::size_t sizes[max_levels];
+        std::size_t levels = 0, total = 0;
+        for ( std::size_t count = size; count > node_size; count = sizes[levels++] )
+        {
+            sizes[levels] = (count + node_size - 1) / node_size;
+            total += sizes[levels];
+        }
+        separators_.resize(total);
+        std::size_t offset = total;
+        const T* below = keys;
+        std::size_t below_size = size;
+        for ( std::size_t level = 0; level < levels; ++level )
+        {
+            offset -= sizes[level];
+            for ( std::size_t i = 0; i < sizes[level]; ++i )
+            {
+                separators_[offset + i] = below[std::min(i * node_size + node_size - 1, below_size - 1)];
+            }
+            below = separators_.data() + offset;
+            below_size = sizes[level];
+        }
+        offset = 0;
+        for ( std::size_t level = 0; level < levels; ++level )
+        {
+            offsets_[level] = offset;
+            sizes_[level] = sizes[levels - 1 - level];
+            offset += sizes_[level];
+        }
+        size_ = size;
+        levels_ = levels;
+        valid_ = true;
+    }
+
+    /**
+     * lower_bound of key in the keys the tree was built from, as an index.
+     */
+    std::size_t lower_bound(const T* keys, const T& key) const
+    {
+        if ( size_ == 0 || keys[size_ - 1] < key )
+        {
+            return size_;
+        }
+        const T* separators = separators_.data();
+        std::size_t child = 0;
+        for ( std::size_t level = 0; level < levels_; ++level )
+        {
+            std::size_t first = child * node_size;
+            child = first + count_less(separators + offsets_[level] + first,
+                                       std::min(node_size, sizes_[level] - first), key);
+        }
+        std::size_t first = child * node_size;
+        return first + count_less(keys + first, std::min(node_size, size_ - first), key);
+    }
+
+    std::size_t size_in_bytes() const noexcept
+    {
+        return separators_.capacity() * sizeof(T);
+    }
+
+    void swap(static_search_tree& other)
+    {
+        separators_.swap(other.separators_);
+        std::swap(size_, other.size_);
+        std::swap(levels_, other.levels_);
+        std::swap(valid_, other.valid_);
+        for ( std::size_t i = 0; i < max_levels; ++i )
+        {
+            std::swap(offsets_[i], other.offsets_[i]);
+            std::swap(sizes_[i], other.sizes_[i]);
+        }
+    }
+
+private:
+    std::vector<T, separator_allocator>     separators_;
+    std::size_t                             offsets_[max_levels];
+    std::size_t                             sizes_[max_levels];
+    std::size_t                             size_;
+    std::size_t                             levels_;
+    bool                                    valid_;
+};  // class static_search_tree
+
+template <class T, class Alloc>
+const std::size_t static_search_tree<T, Alloc>::node_size;
+
+template <class T, class Alloc>
+const std::size_t static_search_tree<T, Alloc>::max_levels;
+
+/**
+ * Owning pointer to a static_search_tree allocated through Alloc on the
+ * first build, so that a container pays one pointer for an index it may
+ * never build. With Enabled false it is an empty class with the same
+ * interface that never holds a tree.
+ */
+template <class T, class Alloc, bool Enabled = true>
+class search_tree_handle
+{
+    typedef          static_search_tree<T, Alloc>                                       tree_type;
+    typedef typename std::allocator_traits<Alloc>::template rebind_alloc<tree_type>     tree_allocator;
+    typedef          std::allocator_traits<tree_allocator>                              tree_traits;
+public:
+    search_tree_handle() noexcept
+    : tree_(nullptr)
+    {
+    }
+
+    search_tree_handle(const search_tree_handle& other, const Alloc& alloc)
+    : tree_(( other.tree_ != nullptr ) ? create(alloc, *other.tree_, alloc) : nullptr)
+    {
+    }
+
+    search_tree_handle(search_tree_handle&& other) noexcept
+    : tree_(other.tree_)
+    {
+        other.tree_ = nullptr;
+    }
+
+    search_tree_handle(const search_tree_handle&) = delete;
+    search_tree_handle& operator=(const search_tree_handle&) = delete;
+
+    search_tree_handle& operator=(search_tree_handle&& other) noexcept
+    {
+        search_tree_handle(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    ~search_tree_handle()
+    {
+        if ( tree_ != nullptr )
+        {
+            tree_allocator alloc(tree_->get_allocator());
+            tree_traits::destroy(alloc, tree_);
+            tree_traits::deallocate(alloc, tree_, 1);
+        }
+    }
+
+    void assign(const search_tree_handle& other, const Alloc& alloc)
+    {
+        search_tree_handle(other, alloc).swap(*this);
+    }
+
+    bool valid() const noexcept
+    {
+        return tree_ != nullptr && tree_->valid();
+    }
+
+    void invalidate() noexcept
+    {
+        if ( tree_ != nullptr )
+        {
+            tree_->invalidate();
+        }
+    }
+
+    void build(const T* keys, std::size_t size, const Alloc& alloc)
+    {
+        if ( tree_ == nullptr )
+        {
+            tree_ = create(alloc, alloc);
+        }
+        tree_->build(keys, size);
+    }
+
+    std::size_t lower_bound(const T* keys, const T& key) const
+    {
+        return tree_->lower_bound(keys, key);
+    }
+
+    void swap(search_tree_handle& other) noexcept
+    {
+        std::swap(tree_, other.tree_);
+    }
+
+private:
+    template <class... Args>
+    static tree_type* create(const Alloc& alloc, Args&&... args)
+    {
+        tree_allocator tree_alloc(alloc);
+        tree_type* tree = tree_traits::allocate(tree_alloc, 1);
+        try
+        {
+            tree_traits::construct(tree_alloc, tree, std::forward<Args>(args)...);
+        }
+        catch ( ... )
+        {
+            tree_traits::deallocate(tree_alloc, tree, 1);
+            throw;
+        }
+        return tree;
+    }
+
+    tree_type* tree_;
+};  // class search_tree_handle
+
+template <class T, class Alloc>
+class search_tree_handle<T, Alloc, false>
+{
+public:
+    search_tree_handle() noexcept
+    {
+    }
+
+    search_tree_handle(const search_tree_handle&, const Alloc&) noexcept
+    {
+    }
+
+    void assign(const search_tree_handle&, const Alloc&) noexcept
+    {
+    }
+
+    bool valid() const noexcept
+    {
+        return false;
+    }
+
+    void invalidate() noexcept
+    {
+    }
+
+    void swap(search_tree_handle&) noexcept
+    {
+    }
+};  // class search_tree_handle
+
+}  // namespace detail
+}  // namespace eos
+
+#endif  // EOS_DETAIL_STATIC_SEARCH_TREE_H_
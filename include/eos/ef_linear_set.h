@@ -0,0 +1,428 @@
+/**
+ * @author Gracjan Olbinski <gracjan.olbinski@gmail.com>
+ */
+
+
+#ifndef EOS_EF_LINEAR_SET_H_
+#define EOS_EF_LINEAR_SET_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <iterator>
+#include <functional>
+#include <type_traits>
+
+#include "eos/linear_set.h"
+#include "eos/detail/platform.h"
+
+namespace eos
+{
+
+/**
+ * Read-only set of unsigned integers in Elias-Fano encoding. Each key is
+ * split into its low `low_bits` bits, stored packed, and its high part,
+ * stored in unary as a bit vector with one set bit per key; that needs about
+ * 2 + log2(max / size) bits per key. Every 256th set and clear bit of the
+ * high vector is sampled so nth() and lower_bound() only scan a few words.
+ */
+template <
+    typename Key,
+    typename Alloc = std::allocator<Key>
+    >
+class ef_linear_set
+{
+    static_assert(std::is_integral<Key>::value && std::is_unsigned<Key>::value,
+                  "ef_linear_set stores unsigned integer keys");
+
+    typedef typename std::allocator_traits<Alloc>::template rebind_alloc<std::uint64_t> word_allocator;
+    typedef          std::vector<std::uint64_t, word_allocator>                      word_vector;
+public:
+    typedef          Key                                    key_type;
+    typedef          Key                                    value_type;
+    typedef          std::less<Key>                         key_compare;
+    typedef          std::less<Key>                         value_compare;
+    typedef          Alloc                                  allocator_type;
+    typedef          value_type                             reference;
+    typedef          value_type                             const_reference;
+    typedef          std::ptrdiff_t                         difference_type;
+    typedef          std::size_t                            size_type;
+
+    /**
+     * Forward iterator decoding keys on the fly; dereferencing returns the
+     * key by value.
+     */
+    class const_iterator
+    {
+    public:
+        typedef std::forward_iterator_tag                   iterator_category;
+        typedef typename ef_linear_set::value_type          value_type;
+        typedef typename ef_linear_set::difference_type     difference_type;
+        typedef const value_type*                           pointer;
+        typedef value_type                                  reference;
+
+        const_iterator() noexcept
+        : set_(nullptr)
+        , index_(0)
+        , position_(0)
+        {
+        }
+
+        reference operator*() const
+        {
+            return set_->decode(index_, position_);
+        }
+
+        const_iterator& operator++()
+        {
+            if ( ++index_ < set_->size_ )
+            {
+                position_ = set_->next_one(position_ + 1);
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int)
+        {
+            const_iterator tmp(*this);
+            ++*this;
+            return tmp;
+        }
+
+        bool operator==(const const_iterator& other) const
+        {
+            return index_ == other.index_;
+        }
+
+        bool operator!=(const const_iterator& other) const
+        {
+            return index_ != other.index_;
+        }
+
+    private:
+        friend class ef_linear_set;
+
+        const_iterator(const ef_linear_set* set, size_type index, size_type position) noexcept
+        : set_(set)
+        , index_(index)
+        , position_(position)
+        {
+        }
+
+        const ef_linear_set*    set_;
+        size_type               index_;
+        size_type               position_;
+    };  // class const_iterator
+
+    typedef          const_iterator                         iterator;
+
+    explicit ef_linear_set(const allocator_type& alloc = allocator_type())
+    : high_(word_allocator(alloc))
+    , low_(word_allocator(alloc))
+    , one_samples_(word_allocator(alloc))
+    , zero_samples_(word_allocator(alloc))
+    , size_(0)
+    , low_bits_(0)
+    , high_size_(0)
+    , max_high_(0)
+    {
+    }
+
+    /**
+     * Encodes [first, last), which must already be sorted and unique.
+     */
+    template <class ForwardIterator>
+    ef_linear_set(ForwardIterator first, ForwardIterator last,
+                  const allocator_type& alloc = allocator_type())
+    : high_(word_allocator(alloc))
+    , low_(word_allocator(alloc))
+    , one_samples_(word_allocator(alloc))
+    , zero_samples_(word_allocator(alloc))
+    , size_(0)
+    , low_bits_(0)
+    , high_size_(0)
+    , max_high_(0)
+    {
+        build(first, last);
+    }
+
+    template <class... Params>
+    explicit ef_linear_set(const linear_set<Key, std::less<Key>, Params...>& set,
+                           const allocator_type& alloc = allocator_type())
+    : high_(word_allocator(alloc))
+    , low_(word_allocator(alloc))
+    , one_samples_(word_allocator(alloc))
+    , zero_samples_(word_allocator(alloc))
+    , size_(0)
+    , low_bits_(0)
+    , high_size_(0)
+    , max_high_(0)
+    {
+        build(set.begin(), set.end());
+    }
+
+    const_iterator begin() const
+    {
+        return ( size_ == 0 ) ? end() : const_iterator(this, 0, select_one(0));
+    }
+
+    const_iterator cbegin() const
+    {
+        return begin();
+    }
+
+    const_iterator end() const noexcept
+    {
+        return const_iterator(this, size_, high_size_);
+    }
+
+    const_iterator cend() const noexcept
+    {
+        return end();
+    }
+
+    bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    size_type size() const noexcept
+    {
+        return size_;
+    }
+
+    /**
+     * The n-th smallest key, n < size().
+     */
+    value_type nth(size_type n) const
+    {
+        return decode(n, select_one(n));
+    }
+
+    void swap(ef_linear_set& other)
+    {
+        high_.swap(other.high_);
+        low_.swap(other.low_);
+        one_samples_.swap(other.one_samples_);
+        zero_samples_.swap(other.zero_samples_);
+        std::swap(size_, other.size_);
+        std::swap(low_bits_, other.low_bits_);
+        std::swap(high_size_, other.high_size_);
+        std::swap(max_high_, other.max_high_);
+    }
+
+    const_iterator find(value_type val) const
+    {
+        const_iterator it = lower_bound(val);
+        return ( it != end() && *it == val ) ? it : end();
+    }
+
+    size_type count(value_type val) const
+    {
+        return ( find(val) != end() ) ? 1 : 0;
+    }
+
+    const_iterator lower_bound(value_type val) const
+    {
+        std::uint64_t high = static_cast<std::uint64_t>(val) >> low_bits_;
+        if ( size_ == 0 || high > max_high_ )
+        {
+            return end();
+        }
+        size_type position = ( high == 0 ) ? 0 : select_zero(high - 1) + 1;
+        size_type index = position - high;
+        std::uint64_t low = static_cast<std::uint64_t>(val) & low_mask();
+        for ( ; bit(position); ++position, ++index )
+        {
+            if ( low_at(index) >= low )
+            {
+                return const_iterator(this, index, position);
+            }
+        }
+        return ( index == size_ ) ? end() : const_iterator(this, index, next_one(position));
+    }
+
+    const_iterator upper_bound(value_type val) const
+    {
+        return ( val == static_cast<value_type>(~value_type(0)) ) ? end() : lower_bound(val + 1);
+    }
+
+    std::pair<const_iterator, const_iterator> equal_range(value_type val) const
+    {
+        const_iterator it = lower_bound(val);
+        if ( it != end() && *it == val )
+        {
+            const_iterator next = it;
+            return std::make_pair(it, ++next);
+        }
+        return std::make_pair(it, it);
+    }
+
+    key_compare key_comp() const
+    {
+        return key_compare();
+    }
+
+    value_compare value_comp() const
+    {
+        return value_compare();
+    }
+
+    allocator_type get_allocator() const
+    {
+        return allocator_type(high_.get_allocator());
+    }
+
+    /**
+     * Bytes held by the encoding, including the sample tables.
+     */
+    size_type memory_usage() const noexcept
+    {
+        return sizeof(*this) + sizeof(std::uint64_t) * (high_.capacity() + low_.capacity() +
+                                                        one_samples_.capacity() + zero_samples_.capacity());
+    }
+
+private:
+    static const size_type sample_rate = 256;
+
+    template <class ForwardIterator>
+    void build(ForwardIterator first, ForwardIterator last)
+    {
+        std::uint64_t max = 0;
+        for ( ForwardIterator it = first; it != last; ++it, ++size_ )
+        {
+            max = *it;
+        }
+        if ( size_ == 0 )
+        {
+            return;
+        }
+        std::uint64_t ratio = max / size_;
+        low_bits_ = ( ratio == 0 ) ? 0 : 63 - detail::count_leading_zeros64(ratio);
+        max_high_ = max >> low_bits_;
+        high_size_ = size_ + max_high_ + 1;
+        high_.assign((high_size_ + 63) / 64, 0);
+        low_.assign((size_ * low_bits_ + 63) / 64 + 1, 0);
+        one_samples_.reserve(size_ / sample_rate + 1);
+
+        size_type index = 0;
+        for ( ; first != last; ++first, ++index )
+        {
+            std::uint64_t val = *first;
+            size_type position = (val >> low_bits_) + index;
+            high_[position / 64] |= std::uint64_t(1) << (position % 64);
+            if ( index % sample_rate == 0 )
+            {
+                one_samples_.push_back(position);
+            }
+            if ( low_bits_ != 0 )
+            {
+                size_type offset = index * low_bits_;
+                std::uint64_t low = val & low_mask();
+                low_[offset / 64] |= low << (offset % 64);
+                if ( offset % 64 + low_bits_ > 64 )
+                {
+                    low_[offset / 64 + 1] |= low >> (64 - offset % 64);
+                }
+            }
+        }
+
+        size_type zeros = 0;
+        for ( size_type word = 0; word < high_.size(); ++word )
+        {
+            std::uint64_t inverted = ~high_[word];
+            if ( (word + 1) * 64 > high_size_ )
+            {
+                inverted &= (std::uint64_t(1) << (high_size_ % 64)) - 1;
+            }
+            size_type count = detail::popcount64(inverted);
+            for ( size_type next = zero_samples_.size() * sample_rate; next < zeros + count; next += sample_rate )
+            {
+                zero_samples_.push_back(word * 64 + detail::select64(inverted, next - zeros));
+            }
+            zeros += count;
+        }
+    }
+
+    std::uint64_t low_mask() const
+    {
+        return (std::uint64_t(1) << low_bits_) - 1;
+    }
+
+    bool bit(size_type position) const
+    {
+        return position < high_size_ && ((high_[position / 64] >> (position % 64)) & 1) != 0;
+    }
+
+    std::uint64_t low_at(size_type index) const
+    {
+        if ( low_bits_ == 0 )
+        {
+            return 0;
+        }
+        size_type offset = index * low_bits_;
+        std::uint64_t val = low_[offset / 64] >> (offset % 64);
+        if ( offset % 64 + low_bits_ > 64 )
+        {
+            val |= low_[offset / 64 + 1] << (64 - offset % 64);
+        }
+        return val & low_mask();
+    }
+
+    value_type decode(size_type index, size_type position) const
+    {
+        return static_cast<value_type>(((position - index) << low_bits_) | low_at(index));
+    }
+
+    size_type next_one(size_type position) const
+    {
+        size_type word = position / 64;
+        std::uint64_t bits = high_[word] & (~std::uint64_t(0) << (position % 64));
+        while ( bits == 0 )
+        {
+            bits = high_[++word];
+        }
+        return word * 64 + detail::count_trailing_zeros64(bits);
+    }
+
+    size_type select_one(size_type rank) const
+    {
+        size_type position = one_samples_[rank / sample_rate];
+        size_type word = position / 64;
+        std::uint64_t bits = high_[word] & (~std::uint64_t(0) << (position % 64));
+        rank %= sample_rate;
+        for ( size_type count = detail::popcount64(bits); rank >= count; count = detail::popcount64(bits) )
+        {
+            rank -= count;
+            bits = high_[++word];
+        }
+        return word * 64 + detail::select64(bits, rank);
+    }
+
+    size_type select_zero(size_type rank) const
+    {
+        size_type position = zero_samples_[rank / sample_rate];
+        size_type word = position / 64;
+        std::uint64_t bits = ~high_[word] & (~std::uint64_t(0) << (position % 64));
+        rank %= sample_rate;
+        for ( size_type count = detail::popcount64(bits); rank >= count; count = detail::popcount64(bits) )
+        {
+            rank -= count;
+            bits = ~high_[++word];
+        }
+        return word * 64 + detail::select64(bits, rank);
+    }
+
+    word_vector     high_;
+    word_vector     low_;
+    word_vector     one_samples_;
+    word_vector     zero_samples_;
+    size_type       size_;
+    unsigned        low_bits_;
+    size_type       high_size_;
+    std::uint64_t   max_high_;
+};  // class ef_linear_set
+
+}  // namespace eos
+
+#endif  // EOS_EF_LINEAR_SET_H_
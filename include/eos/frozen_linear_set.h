@@ -0,0 +1,412 @@
+/**
+ * @author Gracjan Olbinski <gracjan.olbinski@gmail.com>
+ */
+
+
+#ifndef EOS_FROZEN_LINEAR_SET_H_
+#define EOS_FROZEN_LINEAR_SET_H_
+
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <functional>
+
+#include "eos/linear_set.h"
+#include "eos/detail/platform.h"
+
+namespace eos
+{
+
+/**
+ * Read-only sorted set stored in Eytzinger (breadth-first) order. Lookups
+ * run a branchless descent that prefetches the cache line holding the
+ * descendants a few levels down; iteration walks the implicit tree in order.
+ */
+template <
+    typename Key,
+    typename Compare = std::less<Key>,
+    typename Alloc = std::allocator<Key>
+    >
+class frozen_linear_set
+{
+    typedef          std::vector<Key, Alloc>                storage_type;
+public:
+    typedef typename storage_type::value_type               key_type;
+    typedef typename storage_type::value_type               value_type;
+    typedef          Compare                                key_compare;
+    typedef          Compare                                value_compare;
+    typedef typename storage_type::allocator_type           allocator_type;
+    typedef          const value_type&                      reference;
+    typedef          const value_type&                      const_reference;
+    typedef typename storage_type::difference_type          difference_type;
+    typedef typename storage_type::size_type                size_type;
+
+    class const_iterator
+    {
+    public:
+        typedef std::bidirectional_iterator_tag             iterator_category;
+        typedef typename frozen_linear_set::value_type      value_type;
+        typedef typename frozen_linear_set::difference_type difference_type;
+        typedef const value_type*                           pointer;
+        typedef const value_type&                           reference;
+
+        const_iterator() noexcept
+        : base_(nullptr)
+        , size_(0)
+        , node_(0)
+        {
+        }
+
+        reference operator*() const
+        {
+            return base_[node_ - 1];
+        }
+
+        pointer operator->() const
+        {
+            return base_ + node_ - 1;
+        }
+
+        const_iterator& operator++()
+        {
+            node_ = frozen_linear_set::next(node_, size_);
+            return *this;
+        }
+
+        const_iterator operator++(int)
+        {
+            const_iterator tmp(*this);
+            ++*this;
+            return tmp;
+        }
+
+        const_iterator& operator--()
+        {
+            node_ = frozen_linear_set::prev(node_, size_);
+            return *this;
+        }
+
+        const_iterator operator--(int)
+        {
+            const_iterator tmp(*this);
+            --*this;
+            return tmp;
+        }
+
+        bool operator==(const const_iterator& other) const
+        {
+            return node_ == other.node_;
+        }
+
+        bool operator!=(const const_iterator& other) const
+        {
+            return node_ != other.node_;
+        }
+
+    private:
+        friend class frozen_linear_set;
+
+        const_iterator(const value_type* base, size_type size, size_type node) noexcept
+        : base_(base)
+        , size_(size)
+        , node_(node)
+        {
+        }
+
+        const value_type*   base_;
+        size_type           size_;
+        size_type           node_;
+    };  // class const_iterator
+
+    typedef          const_iterator                         iterator;
+    typedef          std::reverse_iterator<const_iterator>  reverse_iterator;
+    typedef          std::reverse_iterator<const_iterator>  const_reverse_iterator;
+
+    explicit frozen_linear_set(const key_compare& comp = key_compare(),
+                               const allocator_type& alloc = allocator_type())
+    : comp_(comp)
+    , storage_(alloc)
+    {
+    }
+
+    template <class InputIterator>
+    frozen_linear_set(InputIterator first, InputIterator last,
+                      const key_compare& comp = key_compare(),
+                      const allocator_type& alloc = allocator_type())
+    : comp_(comp)
+    , storage_(alloc)
+    {
+        linear_set<Key, Compare, Alloc> sorted(first, last, comp, alloc);
+        build(sorted.begin(), sorted.size());
+    }
+
+    template <class... Params>
+    explicit frozen_linear_set(const linear_set<Key, Compare, Params...>& set,
+                               const allocator_type& alloc = allocator_type())
+    : comp_(set.key_comp())
+    , storage_(alloc)
+    {
+        build(set.begin(), set.size());
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return make_iterator(first(size()));
+    }
+
+    const_iterator cbegin() const noexcept
+    {
+        return begin();
+    }
+
+    const_iterator end() const noexcept
+    {
+        return make_iterator(0);
+    }
+
+    const_iterator cend() const noexcept
+    {
+        return end();
+    }
+
+    const_reverse_iterator rbegin() const noexcept
+    {
+        return const_reverse_iterator(end());
+    }
+
+    const_reverse_iterator crbegin() const noexcept
+    {
+        return rbegin();
+    }
+
+    const_reverse_iterator rend() const noexcept
+    {
+        return const_reverse_iterator(begin());
+    }
+
+    const_reverse_iterator crend() const noexcept
+    {
+        return rend();
+    }
+
+    bool empty() const noexcept
+    {
+        return storage_.empty();
+    }
+
+    size_type size() const noexcept
+    {
+        return storage_.size();
+    }
+
+    size_type max_size() const noexcept
+    {
+        return storage_.max_size();
+    }
+
+    void swap(frozen_linear_set& other)
+    {
+        std::swap(comp_, other.comp_);
+        storage_.swap(other.storage_);
+    }
+
+    const_iterator find(const value_type& val) const
+    {
+        return find_node(val);
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    const_iterator find(const K& key) const
+    {
+        return find_node(key);
+    }
+
+    size_type count(const value_type& val) const
+    {
+        return ( find(val) != end() ) ? 1 : 0;
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    size_type count(const K& key) const
+    {
+        return std::distance(lower_bound(key), upper_bound(key));
+    }
+
+    const_iterator lower_bound(const value_type& val) const
+    {
+        return make_iterator(lower_bound_node(val));
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    const_iterator lower_bound(const K& key) const
+    {
+        return make_iterator(lower_bound_node(key));
+    }
+
+    const_iterator upper_bound(const value_type& val) const
+    {
+        return make_iterator(upper_bound_node(val));
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    const_iterator upper_bound(const K& key) const
+    {
+        return make_iterator(upper_bound_node(key));
+    }
+
+    std::pair<const_iterator, const_iterator> equal_range(const value_type& val) const
+    {
+        return std::make_pair(lower_bound(val), upper_bound(val));
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    std::pair<const_iterator, const_iterator> equal_range(const K& key) const
+    {
+        return std::make_pair(lower_bound(key), upper_bound(key));
+    }
+
+    key_compare key_comp() const
+    {
+        return comp_;
+    }
+
+    value_compare value_comp() const
+    {
+        return comp_;
+    }
+
+    allocator_type get_allocator() const
+    {
+        return storage_.get_allocator();
+    }
+
+private:
+    static const size_type prefetch_stride = ( sizeof(Key) < 64 ) ? 64 / sizeof(Key) : 1;
+
+    static size_type first(size_type size)
+    {
+        if ( size == 0 )
+        {
+            return 0;
+        }
+        size_type node = 1;
+        while ( 2 * node <= size )
+        {
+            node = 2 * node;
+        }
+        return node;
+    }
+
+    static size_type next(size_type node, size_type size)
+    {
+        if ( 2 * node + 1 <= size )
+        {
+            node = 2 * node + 1;
+            while ( 2 * node <= size )
+            {
+                node = 2 * node;
+            }
+            return node;
+        }
+        return node >> (detail::count_trailing_ones(node) + 1);
+    }
+
+    static size_type prev(size_type node, size_type size)
+    {
+        if ( node == 0 )
+        {
+            if ( size == 0 )
+            {
+                return 0;
+            }
+            node = 1;
+            while ( 2 * node + 1 <= size )
+            {
+                node = 2 * node + 1;
+            }
+            return node;
+        }
+        if ( 2 * node <= size )
+        {
+            node = 2 * node;
+            while ( 2 * node + 1 <= size )
+            {
+                node = 2 * node + 1;
+            }
+            return node;
+        }
+        while ( node != 0 && (node & 1) == 0 )
+        {
+            node >>= 1;
+        }
+        return node >> 1;
+    }
+
+    template <class RandomAccessIterator>
+    void build(RandomAccessIterator sorted, size_type size)
+    {
+        std::vector<size_type> rank(size);
+        size_type node = first(size);
+        for ( size_type i = 0; i < size; ++i, node = next(node, size) )
+        {
+            rank[node - 1] = i;
+        }
+        storage_.reserve(size);
+        for ( size_type i = 0; i < size; ++i )
+        {
+            storage_.push_back(sorted[rank[i]]);
+        }
+    }
+
+    const_iterator make_iterator(size_type node) const
+    {
+        return const_iterator(storage_.data(), size(), node);
+    }
+
+    template <class K>
+    size_type lower_bound_node(const K& key) const
+    {
+        const value_type* base = storage_.data();
+        size_type size = storage_.size(), node = 1;
+        while ( node <= size )
+        {
+            EOS_PREFETCH(base + std::min(node * prefetch_stride, size - 1));
+            node = 2 * node + static_cast<size_type>(comp_(base[node - 1], key));
+        }
+        return node >> (detail::count_trailing_ones(node) + 1);
+    }
+
+    template <class K>
+    size_type upper_bound_node(const K& key) const
+    {
+        const value_type* base = storage_.data();
+        size_type size = storage_.size(), node = 1;
+        while ( node <= size )
+        {
+            EOS_PREFETCH(base + std::min(node * prefetch_stride, size - 1));
+            node = 2 * node + static_cast<size_type>(!comp_(key, base[node - 1]));
+        }
+        return node >> (detail::count_trailing_ones(node) + 1);
+    }
+
+    template <class K>
+    const_iterator find_node(const K& key) const
+    {
+        size_type node = lower_bound_node(key);
+        if ( node != 0 && !comp_(key, storage_[node - 1]) )
+        {
+            return make_iterator(node);
+        }
+        else
+        {
+            return end();
+        }
+    }
+
+    key_compare     comp_;
+    storage_type    storage_;
+};  // class frozen_linear_set
+
+}  // namespace eos
+
+#endif  // EOS_FROZEN_LINEAR_SET_H_
@@ -0,0 +1,64 @@
+/**
+ * @author Gracjan Olbinski <gracjan.olbinski@gmail.com>
+ */
+
+
+#ifndef EOS_GROWTH_POLICY_H_
+#define EOS_GROWTH_POLICY_H_
+
+#include <cstddef>
+#include <algorithm>
+
+namespace eos
+{
+
+/**
+ * Growth policies decide the capacity a container reserves when an insert
+ * needs more room than it has: next_capacity(capacity, required) returns
+ * the new capacity, which must be at least required.
+ */
+struct default_growth
+{
+    static std::size_t next_capacity(std::size_t capacity, std::size_t required)
+    {
+        return std::max(2 * capacity, required);
+    }
+};  // struct default_growth
+
+/**
+ * Grows by Numerator / Denominator, e.g. geometric_growth<5, 4> for 1.25x.
+ */
+template <std::size_t Numerator, std::size_t Denominator = 1>
+struct geometric_growth
+{
+    static_assert(Numerator > Denominator && Denominator > 0, "geometric_growth needs a factor above 1");
+
+    static std::size_t next_capacity(std::size_t capacity, std::size_t required)
+    {
+        return std::max(capacity / Denominator * Numerator + capacity % Denominator * Numerator / Denominator,
+                        required);
+    }
+};  // struct geometric_growth
+
+template <std::size_t Step>
+struct fixed_growth
+{
+    static_assert(Step > 0, "fixed_growth needs a positive step");
+
+    static std::size_t next_capacity(std::size_t capacity, std::size_t required)
+    {
+        return std::max(capacity + Step, required);
+    }
+};  // struct fixed_growth
+
+struct exact_growth
+{
+    static std::size_t next_capacity(std::size_t, std::size_t required)
+    {
+        return required;
+    }
+};  // struct exact_growth
+
+}  // namespace eos
+
+#endif  // EOS_GROWTH_POLICY_H_
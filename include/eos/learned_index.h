@@ -0,0 +1,229 @@
+/**
+ * @author Gracjan Olbinski <gracjan.olbinski@gmail.com>
+ */
+
+
+#ifndef EOS_LEARNED_INDEX_H_
+#define EOS_LEARNED_INDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "eos/detail/simd_search.h"
+#include "eos/sorted_view.h"
+
+namespace eos
+{
+
+/**
+ * Piecewise linear model over sorted numeric keys, in the spirit of the
+ * PGM index. Each segment predicts the position of a key from its distance
+ * to the first key of the segment, within max_error() positions, so a
+ * lookup searches the segment keys and then a small window of the keys
+ * instead of the whole range. The index does not own the keys: it must be
+ * rebuilt whenever the viewed memory changes, e.g. after any mutation of
+ * the linear_set it was built from.
+ */
+template <typename Key>
+class learned_index
+{
+    static_assert(std::is_arithmetic<Key>::value, "learned_index needs arithmetic keys");
+public:
+    typedef          Key                                    key_type;
+    typedef          Key                                    value_type;
+    typedef          sorted_view<Key>                       view_type;
+    typedef typename view_type::const_iterator              const_iterator;
+    typedef          std::size_t                            size_type;
+
+    explicit learned_index(size_type epsilon = 32)
+    : epsilon_(std::max<size_type>(epsilon, 1))
+    , max_error_(0)
+    {
+    }
+
+    explicit learned_index(view_type keys, size_type epsilon = 32)
+    : epsilon_(std::max<size_type>(epsilon, 1))
+    , max_error_(0)
+    {
+        rebuild(keys);
+    }
+
+    /**
+     * Fits segments greedily: each one grows while some slope keeps every
+     * key of the segment within epsilon positions of its prediction.
+     */
+    void rebuild(view_type keys)
+    {
+        keys_ = keys;
+        segment_keys_.clear();
+        segments_.clear();
+        max_error_ = 0;
+        const double epsilon = static_cast<double>(epsilon_);
+        for ( size_type first = 0, size = keys.size(); first < size; )
+        {
+            Key origin = keys[first];
+            double low = 0.0, high = std::numeric_limits<double>::infinity();
+            size_type last = first + 1;
+            for ( ; last < size; ++last )
+            {
+                double dx = distance(keys[last], origin);
+                double dy = static_cast<double>(last - first);
+                double next_low = std::max(low, (dy - epsilon) / dx);
+                double next_high = std::min(high, (dy + epsilon) / dx);
+                if ( next_low > next_high )
+                {
+                    break;
+                }
+                low = next_low;
+                high = next_high;
+            }
+            segment current = { ( last == first + 1 ) ? 0.0 : (low + high) / 2, first };
+            segment_keys_.push_back(origin);
+            segments_.push_back(current);
+            for ( size_type i = first; i < last; ++i )
+            {
+                size_type predicted = predict(current, origin, keys[i], first, last);
+                max_error_ = std::max(max_error_, ( predicted > i ) ? predicted - i : i - predicted);
+            }
+            first = last;
+        }
+        segment_keys_.shrink_to_fit();
+        segments_.shrink_to_fit();
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return keys_.begin();
+    }
+
+    const_iterator end() const noexcept
+    {
+        return keys_.end();
+    }
+
+    size_type size() const noexcept
+    {
+        return keys_.size();
+    }
+
+    bool empty() const noexcept
+    {
+        return keys_.empty();
+    }
+
+    const_iterator lower_bound(const key_type& key) const
+    {
+        const key_type* data = keys_.data();
+        if ( keys_.empty() || !(data[0] < key) )
+        {
+            return keys_.begin();
+        }
+        size_type index = detail::fast_lower_bound(segment_keys_.begin(), segment_keys_.end(), key,
+                                                   std::less<key_type>()) - segment_keys_.begin();
+        if ( index == segment_keys_.size() || key < segment_keys_[index] )
+        {
+            --index;
+        }
+        size_type first = segments_[index].position;
+        size_type last = ( index + 1 < segments_.size() ) ? segments_[index + 1].position : keys_.size();
+        size_type predicted = predict(segments_[index], segment_keys_[index], key, first, last);
+        size_type low = std::max(first, ( predicted > max_error_ + 1 ) ? predicted - max_error_ - 1 : 0);
+        size_type high = std::min(last, predicted + max_error_ + 2);
+        const key_type* it = detail::fast_lower_bound(data + low, data + high, key, std::less<key_type>());
+        if ( ( it == data + low && low > first && !(data[low - 1] < key) ) ||
+             ( it == data + high && high < last && data[high] < key ) )
+        {
+            it = detail::fast_lower_bound(data + first, data + last, key, std::less<key_type>());
+        }
+        return it;
+    }
+
+    const_iterator upper_bound(const key_type& key) const
+    {
+        const_iterator it = lower_bound(key);
+        return ( it != end() && !(key < *it) ) ? it + 1 : it;
+    }
+
+    const_iterator find(const key_type& key) const
+    {
+        const_iterator it = lower_bound(key);
+        return ( it != end() && !(key < *it) ) ? it : end();
+    }
+
+    size_type count(const key_type& key) const
+    {
+        return ( find(key) != end() ) ? 1 : 0;
+    }
+
+    size_type epsilon() const noexcept
+    {
+        return epsilon_;
+    }
+
+    /**
+     * Largest distance between a predicted and an actual key position seen
+     * while building; lookups search twice this window.
+     */
+    size_type max_error() const noexcept
+    {
+        return max_error_;
+    }
+
+    size_type segment_count() const noexcept
+    {
+        return segments_.size();
+    }
+
+    size_type size_in_bytes() const noexcept
+    {
+        return sizeof(*this) + segment_keys_.capacity() * sizeof(key_type) + segments_.capacity() * sizeof(segment);
+    }
+
+private:
+    struct segment
+    {
+        double          slope;
+        size_type       position;
+    };
+
+    /**
+     * key - origin for key >= origin, computed without overflow; integers
+     * are subtracted as unsigned 64-bit values.
+     */
+    template <class K = Key>
+    static typename std::enable_if<std::is_integral<K>::value, double>::type distance(K key, K origin)
+    {
+        return static_cast<double>(static_cast<std::uint64_t>(key) - static_cast<std::uint64_t>(origin));
+    }
+
+    template <class K = Key>
+    static typename std::enable_if<std::is_floating_point<K>::value, double>::type distance(K key, K origin)
+    {
+        return static_cast<double>(key) - static_cast<double>(origin);
+    }
+
+    static size_type predict(const segment& current, key_type origin, key_type key, size_type first, size_type last)
+    {
+        double offset = current.slope * distance(key, origin);
+        if ( !(offset < static_cast<double>(last - first)) )
+        {
+            return last;
+        }
+        return first + static_cast<size_type>(std::max(offset, 0.0));
+    }
+
+    view_type                   keys_;
+    size_type                   epsilon_;
+    size_type                   max_error_;
+    std::vector<key_type>       segment_keys_;
+    std::vector<segment>        segments_;
+};  // class learned_index
+
+}  // namespace eos
+
+#endif  // EOS_LEARNED_INDEX_H_
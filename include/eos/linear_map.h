@@ -0,0 +1,815 @@
+/**
+ * @author Gracjan Olbinski <gracjan.olbinski@gmail.com>
+ */
+
+
+#ifndef EOS_LINEAR_MAP_H_
+#define EOS_LINEAR_MAP_H_
+
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "eos/sorted_view.h"
+#include "eos/detail/algorithm.h"
+#include "eos/detail/simd_search.h"
+
+namespace eos
+{
+namespace detail
+{
+
+/**
+ * Element of the mapped array of linear_map. bool is wrapped in a byte so
+ * that the array is not a std::vector<bool> and every value is addressable.
+ */
+template <class T>
+struct mapped_element
+{
+    typedef T type;
+
+    static T& get(T& element) noexcept
+    {
+        return element;
+    }
+
+    static const T& get(const T& element) noexcept
+    {
+        return element;
+    }
+};  // struct mapped_element
+
+struct boolean_element
+{
+    boolean_element(bool val = false) noexcept
+    : value(val)
+    {
+    }
+
+    bool value;
+};  // struct boolean_element
+
+template <>
+struct mapped_element<bool>
+{
+    typedef boolean_element type;
+
+    static bool& get(boolean_element& element) noexcept
+    {
+        return element.value;
+    }
+
+    static const bool& get(const boolean_element& element) noexcept
+    {
+        return element.value;
+    }
+};  // struct mapped_element
+
+}  // namespace detail
+
+/**
+ * Sorted-vector map keeping keys and mapped values in two parallel arrays,
+ * so lookups only touch the key array. Iterators dereference to a
+ * std::pair<const Key&, T&> proxy rather than to a stored value_type.
+ */
+template <
+    typename Key,
+    typename T,
+    typename Compare = std::less<Key>,
+    typename Alloc = std::allocator<std::pair<const Key, T> >
+    >
+class linear_map
+{
+    typedef          std::allocator_traits<Alloc>                               alloc_traits;
+    typedef          detail::mapped_element<T>                                  element_traits;
+    typedef typename element_traits::type                                       element_type;
+    typedef          std::vector<Key, typename alloc_traits::template rebind_alloc<Key> >   key_storage;
+    typedef          std::vector<element_type,
+                                 typename alloc_traits::template rebind_alloc<element_type> >   mapped_storage;
+
+    template <bool Const>
+    class basic_iterator
+    {
+        typedef typename std::conditional<Const, const T, T>::type  mapped_value;
+        typedef typename std::conditional<
+            Const, const element_type, element_type>::type          mapped_element;
+    public:
+        typedef std::random_access_iterator_tag                     iterator_category;
+        typedef std::pair<const Key, T>                             value_type;
+        typedef std::ptrdiff_t                                      difference_type;
+        typedef std::pair<const Key&, mapped_value&>                reference;
+
+        class pointer
+        {
+        public:
+            explicit pointer(const reference& ref)
+            : ref_(ref)
+            {
+            }
+
+            const reference* operator->() const
+            {
+                return &ref_;
+            }
+
+        private:
+            reference ref_;
+        };  // class pointer
+
+        basic_iterator() noexcept
+        : key_(nullptr)
+        , mapped_(nullptr)
+        {
+        }
+
+        template <bool OtherConst, class = typename std::enable_if<Const && !OtherConst>::type>
+        basic_iterator(const basic_iterator<OtherConst>& other) noexcept
+        : key_(other.key_)
+        , mapped_(other.mapped_)
+        {
+        }
+
+        reference operator*() const
+        {
+            return reference(*key_, element_traits::get(*mapped_));
+        }
+
+        pointer operator->() const
+        {
+            return pointer(**this);
+        }
+
+        reference operator[](difference_type n) const
+        {
+            return reference(key_[n], element_traits::get(mapped_[n]));
+        }
+
+        basic_iterator& operator++()
+        {
+            ++key_;
+            ++mapped_;
+            return *this;
+        }
+
+        basic_iterator operator++(int)
+        {
+            basic_iterator tmp(*this);
+            ++*this;
+            return tmp;
+        }
+
+        basic_iterator& operator--()
+        {
+            --key_;
+            --mapped_;
+            return *this;
+        }
+
+        basic_iterator operator--(int)
+        {
+            basic_iterator tmp(*this);
+            --*this;
+            return tmp;
+        }
+
+        basic_iterator& operator+=(difference_type n)
+        {
+            key_ += n;
+            mapped_ += n;
+            return *this;
+        }
+
+        basic_iterator& operator-=(difference_type n)
+        {
+            key_ -= n;
+            mapped_ -= n;
+            return *this;
+        }
+
+        basic_iterator operator+(difference_type n) const
+        {
+            return basic_iterator(key_ + n, mapped_ + n);
+        }
+
+        friend basic_iterator operator+(difference_type n, const basic_iterator& it)
+        {
+            return it + n;
+        }
+
+        basic_iterator operator-(difference_type n) const
+        {
+            return basic_iterator(key_ - n, mapped_ - n);
+        }
+
+        difference_type operator-(const basic_iterator& other) const
+        {
+            return key_ - other.key_;
+        }
+
+        bool operator==(const basic_iterator& other) const
+        {
+            return key_ == other.key_;
+        }
+
+        bool operator!=(const basic_iterator& other) const
+        {
+            return key_ != other.key_;
+        }
+
+        bool operator<(const basic_iterator& other) const
+        {
+            return key_ < other.key_;
+        }
+
+        bool operator>(const basic_iterator& other) const
+        {
+            return key_ > other.key_;
+        }
+
+        bool operator<=(const basic_iterator& other) const
+        {
+            return key_ <= other.key_;
+        }
+
+        bool operator>=(const basic_iterator& other) const
+        {
+            return key_ >= other.key_;
+        }
+
+    private:
+        friend class linear_map;
+        friend class basic_iterator<!Const>;
+
+        basic_iterator(const Key* key, mapped_element* mapped) noexcept
+        : key_(key)
+        , mapped_(mapped)
+        {
+        }
+
+        const Key*          key_;
+        mapped_element*     mapped_;
+    };  // class basic_iterator
+public:
+    typedef          Key                                    key_type;
+    typedef          T                                      mapped_type;
+    typedef          std::pair<const Key, T>                value_type;
+    typedef          Compare                                key_compare;
+    typedef          Alloc                                  allocator_type;
+    typedef          basic_iterator<false>                  iterator;
+    typedef          basic_iterator<true>                   const_iterator;
+    typedef typename iterator::reference                    reference;
+    typedef typename const_iterator::reference              const_reference;
+    typedef          std::reverse_iterator<iterator>        reverse_iterator;
+    typedef          std::reverse_iterator<const_iterator>  const_reverse_iterator;
+    typedef          std::ptrdiff_t                         difference_type;
+    typedef          std::size_t                            size_type;
+
+    class value_compare
+    {
+    public:
+        template <class L, class R>
+        bool operator()(const L& lhs, const R& rhs) const
+        {
+            return comp_(lhs.first, rhs.first);
+        }
+
+    private:
+        friend class linear_map;
+
+        explicit value_compare(const key_compare& comp)
+        : comp_(comp)
+        {
+        }
+
+        key_compare comp_;
+    };  // class value_compare
+
+    explicit linear_map(const key_compare& comp = key_compare(),
+                        const allocator_type& alloc = allocator_type())
+    : comp_(comp)
+    , keys_(alloc)
+    , mapped_(alloc)
+    {
+    }
+
+    template <class InputIterator>
+    linear_map(InputIterator first, InputIterator last,
+               const key_compare& comp = key_compare(),
+               const allocator_type& alloc = allocator_type())
+    : comp_(comp)
+    , keys_(alloc)
+    , mapped_(alloc)
+    {
+        insert(first, last);
+    }
+
+    linear_map(std::initializer_list<value_type> il,
+               const key_compare& comp = key_compare(),
+               const allocator_type& alloc = allocator_type())
+    : comp_(comp)
+    , keys_(alloc)
+    , mapped_(alloc)
+    {
+        insert(il.begin(), il.end());
+    }
+
+    linear_map& operator=(std::initializer_list<value_type> il)
+    {
+        clear();
+        insert(il.begin(), il.end());
+        return *this;
+    }
+
+    iterator begin() noexcept
+    {
+        return iterator(keys_.data(), mapped_.data());
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return const_iterator(keys_.data(), mapped_.data());
+    }
+
+    const_iterator cbegin() const noexcept
+    {
+        return begin();
+    }
+
+    iterator end() noexcept
+    {
+        return begin() + size();
+    }
+
+    const_iterator end() const noexcept
+    {
+        return begin() + size();
+    }
+
+    const_iterator cend() const noexcept
+    {
+        return end();
+    }
+
+    reverse_iterator rbegin() noexcept
+    {
+        return reverse_iterator(end());
+    }
+
+    const_reverse_iterator rbegin() const noexcept
+    {
+        return const_reverse_iterator(end());
+    }
+
+    const_reverse_iterator crbegin() const noexcept
+    {
+        return rbegin();
+    }
+
+    reverse_iterator rend() noexcept
+    {
+        return reverse_iterator(begin());
+    }
+
+    const_reverse_iterator rend() const noexcept
+    {
+        return const_reverse_iterator(begin());
+    }
+
+    const_reverse_iterator crend() const noexcept
+    {
+        return rend();
+    }
+
+    bool empty() const noexcept
+    {
+        return keys_.empty();
+    }
+
+    size_type size() const noexcept
+    {
+        return keys_.size();
+    }
+
+    size_type max_size() const noexcept
+    {
+        return std::min(keys_.max_size(), mapped_.max_size());
+    }
+
+    mapped_type& operator[](const key_type& key)
+    {
+        return try_emplace(key).first->second;
+    }
+
+    mapped_type& operator[](key_type&& key)
+    {
+        return try_emplace(std::move(key)).first->second;
+    }
+
+    mapped_type& at(const key_type& key)
+    {
+        iterator it = find(key);
+        if ( it == end() )
+        {
+            throw std::out_of_range("linear_map::at");
+        }
+        return it->second;
+    }
+
+    const mapped_type& at(const key_type& key) const
+    {
+        const_iterator it = find(key);
+        if ( it == end() )
+        {
+            throw std::out_of_range("linear_map::at");
+        }
+        return it->second;
+    }
+
+    std::pair<iterator, bool> insert(const value_type& val)
+    {
+        return try_emplace(val.first, val.second);
+    }
+
+    template <class P, class = typename std::enable_if<std::is_constructible<value_type, P&&>::value>::type>
+    std::pair<iterator, bool> insert(P&& val)
+    {
+        value_type pair(std::forward<P>(val));
+        return try_emplace(pair.first, std::move(pair.second));
+    }
+
+    iterator insert(const_iterator, const value_type& val)
+    {
+        return insert(val).first;
+    }
+
+    /**
+     * Appends the range, sorts and dedupes the appended part on its own and
+     * merges it into the existing entries. Keys already present keep their
+     * mapped value, as do the first occurrences of keys repeated in the range.
+     */
+    template <class InputIterator>
+    void insert(InputIterator first, InputIterator last)
+    {
+        size_type count = size();
+        try
+        {
+            for ( ; first != last; ++first )
+            {
+                keys_.push_back(first->first);
+                try
+                {
+                    mapped_.push_back(first->second);
+                }
+                catch ( ... )
+                {
+                    keys_.pop_back();
+                    throw;
+                }
+            }
+        }
+        catch ( ... )
+        {
+            truncate(count);
+            throw;
+        }
+        merge_unique(count);
+    }
+
+    void insert(std::initializer_list<value_type> il)
+    {
+        insert(il.begin(), il.end());
+    }
+
+    template <class... Args>
+    std::pair<iterator, bool> emplace(Args&&... args)
+    {
+        value_type pair(std::forward<Args>(args)...);
+        return try_emplace(pair.first, std::move(pair.second));
+    }
+
+    template <class... Args>
+    std::pair<iterator, bool> try_emplace(const key_type& key, Args&&... args)
+    {
+        size_type index = lower_bound_index(key);
+        if ( index != size() && !comp_(key, keys_[index]) )
+        {
+            return std::make_pair(begin() + index, false);
+        }
+        return std::make_pair(emplace_at(index, key, std::forward<Args>(args)...), true);
+    }
+
+    template <class... Args>
+    std::pair<iterator, bool> try_emplace(key_type&& key, Args&&... args)
+    {
+        size_type index = lower_bound_index(key);
+        if ( index != size() && !comp_(key, keys_[index]) )
+        {
+            return std::make_pair(begin() + index, false);
+        }
+        return std::make_pair(emplace_at(index, std::move(key), std::forward<Args>(args)...), true);
+    }
+
+    template <class M>
+    std::pair<iterator, bool> insert_or_assign(const key_type& key, M&& obj)
+    {
+        std::pair<iterator, bool> result = try_emplace(key, std::forward<M>(obj));
+        if ( !result.second )
+        {
+            result.first->second = std::forward<M>(obj);
+        }
+        return result;
+    }
+
+    template <class M>
+    std::pair<iterator, bool> insert_or_assign(key_type&& key, M&& obj)
+    {
+        std::pair<iterator, bool> result = try_emplace(std::move(key), std::forward<M>(obj));
+        if ( !result.second )
+        {
+            result.first->second = std::forward<M>(obj);
+        }
+        return result;
+    }
+
+    iterator erase(const_iterator position)
+    {
+        return erase(position, position + 1);
+    }
+
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        size_type from = first - cbegin(), to = last - cbegin();
+        keys_.erase(keys_.begin() + from, keys_.begin() + to);
+        mapped_.erase(mapped_.begin() + from, mapped_.begin() + to);
+        return begin() + from;
+    }
+
+    size_type erase(const key_type& key)
+    {
+        iterator it = find(key);
+        if ( it == end() )
+        {
+            return 0;
+        }
+        erase(it);
+        return 1;
+    }
+
+    void swap(linear_map& other)
+    {
+        std::swap(comp_, other.comp_);
+        keys_.swap(other.keys_);
+        mapped_.swap(other.mapped_);
+    }
+
+    void clear() noexcept
+    {
+        keys_.clear();
+        mapped_.clear();
+    }
+
+    void reserve(size_type n)
+    {
+        keys_.reserve(n);
+        mapped_.reserve(n);
+    }
+
+    /**
+     * Non-owning view of the sorted keys, valid until the map is next modified.
+     */
+    sorted_view<Key, Compare> keys() const noexcept
+    {
+        return sorted_view<Key, Compare>(keys_.data(), keys_.size(), comp_);
+    }
+
+    iterator find(const key_type& key)
+    {
+        return begin() + find_index(key);
+    }
+
+    const_iterator find(const key_type& key) const
+    {
+        return begin() + find_index(key);
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    iterator find(const K& key)
+    {
+        return begin() + find_index(key);
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    const_iterator find(const K& key) const
+    {
+        return begin() + find_index(key);
+    }
+
+    size_type count(const key_type& key) const
+    {
+        return ( find_index(key) != size() ) ? 1 : 0;
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    size_type count(const K& key) const
+    {
+        return upper_bound(key) - lower_bound(key);
+    }
+
+    iterator lower_bound(const key_type& key)
+    {
+        return begin() + lower_bound_index(key);
+    }
+
+    const_iterator lower_bound(const key_type& key) const
+    {
+        return begin() + lower_bound_index(key);
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    iterator lower_bound(const K& key)
+    {
+        return begin() + lower_bound_index(key);
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    const_iterator lower_bound(const K& key) const
+    {
+        return begin() + lower_bound_index(key);
+    }
+
+    iterator upper_bound(const key_type& key)
+    {
+        return begin() + upper_bound_index(key);
+    }
+
+    const_iterator upper_bound(const key_type& key) const
+    {
+        return begin() + upper_bound_index(key);
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    iterator upper_bound(const K& key)
+    {
+        return begin() + upper_bound_index(key);
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    const_iterator upper_bound(const K& key) const
+    {
+        return begin() + upper_bound_index(key);
+    }
+
+    std::pair<iterator, iterator> equal_range(const key_type& key)
+    {
+        return std::make_pair(lower_bound(key), upper_bound(key));
+    }
+
+    std::pair<const_iterator, const_iterator> equal_range(const key_type& key) const
+    {
+        return std::make_pair(lower_bound(key), upper_bound(key));
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    std::pair<iterator, iterator> equal_range(const K& key)
+    {
+        return std::make_pair(lower_bound(key), upper_bound(key));
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    std::pair<const_iterator, const_iterator> equal_range(const K& key) const
+    {
+        return std::make_pair(lower_bound(key), upper_bound(key));
+    }
+
+    key_compare key_comp() const
+    {
+        return comp_;
+    }
+
+    value_compare value_comp() const
+    {
+        return value_compare(comp_);
+    }
+
+    allocator_type get_allocator() const
+    {
+        return allocator_type(keys_.get_allocator());
+    }
+
+private:
+    struct index_compare
+    {
+        bool operator()(size_type lhs, size_type rhs) const
+        {
+            return (*comp)(keys[lhs], keys[rhs]);
+        }
+
+        const key_compare*  comp;
+        const Key*          keys;
+    };  // struct index_compare
+
+    template <class K>
+    size_type lower_bound_index(const K& key) const
+    {
+        return detail::fast_lower_bound(keys_.begin(), keys_.end(), key, comp_) - keys_.begin();
+    }
+
+    template <class K>
+    size_type upper_bound_index(const K& key) const
+    {
+        return std::upper_bound(keys_.begin(), keys_.end(), key, comp_) - keys_.begin();
+    }
+
+    template <class K>
+    size_type find_index(const K& key) const
+    {
+        size_type index = lower_bound_index(key);
+        return ( index != size() && !comp_(key, keys_[index]) ) ? index : size();
+    }
+
+    template <class K, class... Args>
+    iterator emplace_at(size_type index, K&& key, Args&&... args)
+    {
+        keys_.insert(keys_.begin() + index, std::forward<K>(key));
+        try
+        {
+            mapped_.emplace(mapped_.begin() + index, std::forward<Args>(args)...);
+        }
+        catch ( ... )
+        {
+            keys_.erase(keys_.begin() + index);
+            throw;
+        }
+        return begin() + index;
+    }
+
+    void truncate(size_type count)
+    {
+        keys_.erase(keys_.begin() + count, keys_.end());
+        mapped_.erase(mapped_.begin() + count, mapped_.end());
+    }
+
+    /**
+     * Sorts and dedupes the entries from middle on and merges them into the
+     * ones before, through a permutation of indices so that keys and mapped
+     * values move together.
+     */
+    void merge_unique(size_type middle)
+    {
+        bool ordered = middle == 0 || middle == size() || comp_(keys_[middle - 1], keys_[middle]);
+        for ( size_type i = middle + 1; i < size() && ordered; ++i )
+        {
+            ordered = comp_(keys_[i - 1], keys_[i]);
+        }
+        if ( ordered )
+        {
+            return;
+        }
+        std::vector<size_type> order(size());
+        std::iota(order.begin(), order.end(), size_type(0));
+        index_compare comp = { &comp_, keys_.data() };
+        std::vector<size_type>::iterator last = detail::sort_unique(order.begin() + middle, order.end(), comp);
+        last = detail::merge_unique(order.begin(), order.begin() + middle, last, comp);
+        order.erase(last, order.end());
+        for ( size_type i = 0; i < order.size(); ++i )
+        {
+            if ( order[i] != i )
+            {
+                permute(order);
+                return;
+            }
+        }
+        truncate(order.size());
+    }
+
+    void permute(const std::vector<size_type>& order)
+    {
+        key_storage keys(keys_.get_allocator());
+        mapped_storage mapped(mapped_.get_allocator());
+        keys.reserve(order.size());
+        mapped.reserve(order.size());
+        for ( size_type i = 0; i < order.size(); ++i )
+        {
+            keys.push_back(std::move(keys_[order[i]]));
+            mapped.push_back(std::move(mapped_[order[i]]));
+        }
+        keys_.swap(keys);
+        mapped_.swap(mapped);
+    }
+
+    key_compare     comp_;
+    key_storage     keys_;
+    mapped_storage  mapped_;
+};  // class linear_map
+
+}  // namespace eos
+
+#endif  // EOS_LINEAR_MAP_H_
@@ -0,0 +1,655 @@
+/**
+ * @author Gracjan Olbinski <gracjan.olbinski@gmail.com>
+ */
+
+
+#ifndef EOS_LINEAR_MULTISET_H_
+#define EOS_LINEAR_MULTISET_H_
+
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "eos/linear_map.h"
+#include "eos/detail/simd_search.h"
+
+namespace eos
+{
+
+/**
+ * Sorted-vector multiset. Equivalent keys are kept in insertion order, and
+ * a new key is placed after the ones already present, like std::multiset.
+ */
+template <
+    typename Key,
+    typename Compare = std::less<Key>,
+    typename Alloc = std::allocator<Key>
+    >
+class linear_multiset
+{
+    typedef          std::vector<Key, Alloc>                storage_type;
+public:
+    typedef typename storage_type::value_type               key_type;
+    typedef typename storage_type::value_type               value_type;
+    typedef          Compare                                key_compare;
+    typedef          Compare                                value_compare;
+    typedef typename storage_type::allocator_type           allocator_type;
+    typedef          value_type&                            reference;
+    typedef          const value_type&                      const_reference;
+    typedef typename storage_type::iterator                 iterator;
+    typedef typename storage_type::const_iterator           const_iterator;
+    typedef typename storage_type::reverse_iterator         reverse_iterator;
+    typedef typename storage_type::const_reverse_iterator   const_reverse_iterator;
+    typedef typename storage_type::difference_type          difference_type;
+    typedef typename storage_type::size_type                size_type;
+
+    explicit linear_multiset(const key_compare& comp = key_compare(),
+                             const allocator_type& alloc = allocator_type())
+    : comp_(comp)
+    , storage_(alloc)
+    {
+    }
+
+    template <class InputIterator>
+    linear_multiset(InputIterator first, InputIterator last,
+                    const key_compare& comp = key_compare(),
+                    const allocator_type& alloc = allocator_type())
+    : comp_(comp)
+    , storage_(first, last, alloc)
+    {
+        sort(storage_.begin());
+    }
+
+    linear_multiset(std::initializer_list<value_type> il,
+                    const key_compare& comp = key_compare(),
+                    const allocator_type& alloc = allocator_type())
+    : comp_(comp)
+    , storage_(il, alloc)
+    {
+        sort(storage_.begin());
+    }
+
+    linear_multiset& operator=(std::initializer_list<value_type> il)
+    {
+        storage_type(il, storage_.get_allocator()).swap(storage_);
+        sort(storage_.begin());
+        return *this;
+    }
+
+    iterator begin() noexcept
+    {
+        return storage_.begin();
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return storage_.begin();
+    }
+
+    const_iterator cbegin() const noexcept
+    {
+        return storage_.cbegin();
+    }
+
+    iterator end() noexcept
+    {
+        return storage_.end();
+    }
+
+    const_iterator end() const noexcept
+    {
+        return storage_.end();
+    }
+
+    const_iterator cend() const noexcept
+    {
+        return storage_.cend();
+    }
+
+    reverse_iterator rbegin() noexcept
+    {
+        return storage_.rbegin();
+    }
+
+    const_reverse_iterator rbegin() const noexcept
+    {
+        return storage_.rbegin();
+    }
+
+    const_reverse_iterator crbegin() const noexcept
+    {
+        return storage_.crbegin();
+    }
+
+    reverse_iterator rend() noexcept
+    {
+        return storage_.rend();
+    }
+
+    const_reverse_iterator rend() const noexcept
+    {
+        return storage_.rend();
+    }
+
+    const_reverse_iterator crend() const noexcept
+    {
+        return storage_.crend();
+    }
+
+    bool empty() const noexcept
+    {
+        return storage_.empty();
+    }
+
+    size_type size() const noexcept
+    {
+        return storage_.size();
+    }
+
+    size_type max_size() const noexcept
+    {
+        return storage_.max_size();
+    }
+
+    iterator insert(const value_type& val)
+    {
+        return storage_.insert(upper_bound(val), val);
+    }
+
+    iterator insert(value_type&& val)
+    {
+        iterator it = upper_bound(val);
+        return storage_.insert(it, std::move(val));
+    }
+
+    iterator insert(iterator, const value_type& val)
+    {
+        return insert(val);
+    }
+
+    template <class InputIterator>
+    void insert(InputIterator first, InputIterator last)
+    {
+        size_type count = size();
+        storage_.insert(storage_.end(), first, last);
+        sort(begin() + count);
+        if ( count != 0 && count != size() && comp_(storage_[count], storage_[count - 1]) )
+        {
+            std::inplace_merge(begin(), begin() + count, end(), comp_);
+        }
+    }
+
+    template <class... Args>
+    iterator emplace(Args&&... args)
+    {
+        return insert(value_type(std::forward<Args>(args)...));
+    }
+
+    void erase(iterator position)
+    {
+        storage_.erase(position);
+    }
+
+    void erase(iterator first, iterator last)
+    {
+        storage_.erase(first, last);
+    }
+
+    size_type erase(const value_type& val)
+    {
+        std::pair<iterator, iterator> range = equal_range(val);
+        size_type count = range.second - range.first;
+        storage_.erase(range.first, range.second);
+        return count;
+    }
+
+    void swap(linear_multiset& other)
+    {
+        std::swap(comp_, other.comp_);
+        storage_.swap(other.storage_);
+    }
+
+    void clear() noexcept
+    {
+        storage_.clear();
+    }
+
+    iterator find(const value_type& val)
+    {
+        iterator it = lower_bound(val);
+        return ( it != end() && !comp_(val, *it) ) ? it : end();
+    }
+
+    const_iterator find(const value_type& val) const
+    {
+        const_iterator it = lower_bound(val);
+        return ( it != end() && !comp_(val, *it) ) ? it : end();
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    const_iterator find(const K& key) const
+    {
+        const_iterator it = lower_bound(key);
+        return ( it != end() && !comp_(key, *it) ) ? it : end();
+    }
+
+    size_type count(const value_type& val) const
+    {
+        std::pair<const_iterator, const_iterator> range = equal_range(val);
+        return range.second - range.first;
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    size_type count(const K& key) const
+    {
+        std::pair<const_iterator, const_iterator> range = equal_range(key);
+        return range.second - range.first;
+    }
+
+    iterator lower_bound(const value_type& val)
+    {
+        return detail::fast_lower_bound(begin(), end(), val, comp_);
+    }
+
+    const_iterator lower_bound(const value_type& val) const
+    {
+        return detail::fast_lower_bound(begin(), end(), val, comp_);
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    const_iterator lower_bound(const K& key) const
+    {
+        return std::lower_bound(begin(), end(), key, comp_);
+    }
+
+    iterator upper_bound(const value_type& val)
+    {
+        return std::upper_bound(begin(), end(), val, comp_);
+    }
+
+    const_iterator upper_bound(const value_type& val) const
+    {
+        return std::upper_bound(begin(), end(), val, comp_);
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    const_iterator upper_bound(const K& key) const
+    {
+        return std::upper_bound(begin(), end(), key, comp_);
+    }
+
+    std::pair<iterator, iterator> equal_range(const value_type& val)
+    {
+        iterator first = lower_bound(val);
+        return std::make_pair(first, std::upper_bound(first, end(), val, comp_));
+    }
+
+    std::pair<const_iterator, const_iterator> equal_range(const value_type& val) const
+    {
+        const_iterator first = lower_bound(val);
+        return std::make_pair(first, std::upper_bound(first, end(), val, comp_));
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    std::pair<const_iterator, const_iterator> equal_range(const K& key) const
+    {
+        return std::equal_range(begin(), end(), key, comp_);
+    }
+
+    key_compare key_comp() const
+    {
+        return comp_;
+    }
+
+    value_compare value_comp() const
+    {
+        return comp_;
+    }
+
+    allocator_type get_allocator() const
+    {
+        return storage_.get_allocator();
+    }
+
+private:
+    void sort(iterator first)
+    {
+        if ( !std::is_sorted(first, end(), comp_) )
+        {
+            std::stable_sort(first, end(), comp_);
+        }
+    }
+
+    key_compare     comp_;
+    storage_type    storage_;
+};  // class linear_multiset
+
+/**
+ * Multiset storing every distinct key once together with its multiplicity,
+ * in a linear_map. Memory grows with the number of distinct keys; iteration
+ * still visits each key as many times as it was inserted. Equivalent keys
+ * are collapsed onto the first one inserted.
+ */
+template <
+    typename Key,
+    typename Compare = std::less<Key>,
+    typename Alloc = std::allocator<Key>
+    >
+class compact_linear_multiset
+{
+    typedef          std::allocator_traits<Alloc>           alloc_traits;
+    typedef          linear_map<Key, std::size_t, Compare,
+                                typename alloc_traits::template rebind_alloc<std::pair<const Key, std::size_t> > >
+                                                            storage_type;
+public:
+    typedef          Key                                    key_type;
+    typedef          Key                                    value_type;
+    typedef          Compare                                key_compare;
+    typedef          Compare                                value_compare;
+    typedef          Alloc                                  allocator_type;
+    typedef          const value_type&                      reference;
+    typedef          const value_type&                      const_reference;
+    typedef          std::ptrdiff_t                         difference_type;
+    typedef          std::size_t                            size_type;
+
+    class const_iterator
+    {
+    public:
+        typedef std::bidirectional_iterator_tag                 iterator_category;
+        typedef typename compact_linear_multiset::value_type    value_type;
+        typedef typename compact_linear_multiset::difference_type difference_type;
+        typedef const value_type*                               pointer;
+        typedef const value_type&                               reference;
+
+        const_iterator()
+        : offset_(0)
+        {
+        }
+
+        reference operator*() const
+        {
+            return it_->first;
+        }
+
+        pointer operator->() const
+        {
+            return &it_->first;
+        }
+
+        const_iterator& operator++()
+        {
+            if ( ++offset_ == it_->second )
+            {
+                ++it_;
+                offset_ = 0;
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int)
+        {
+            const_iterator tmp(*this);
+            ++*this;
+            return tmp;
+        }
+
+        const_iterator& operator--()
+        {
+            if ( offset_ == 0 )
+            {
+                --it_;
+                offset_ = it_->second;
+            }
+            --offset_;
+            return *this;
+        }
+
+        const_iterator operator--(int)
+        {
+            const_iterator tmp(*this);
+            --*this;
+            return tmp;
+        }
+
+        bool operator==(const const_iterator& other) const
+        {
+            return it_ == other.it_ && offset_ == other.offset_;
+        }
+
+        bool operator!=(const const_iterator& other) const
+        {
+            return !(*this == other);
+        }
+
+    private:
+        friend class compact_linear_multiset;
+
+        const_iterator(typename storage_type::const_iterator it, size_type offset)
+        : it_(it)
+        , offset_(offset)
+        {
+        }
+
+        typename storage_type::const_iterator   it_;
+        size_type                               offset_;
+    };  // class const_iterator
+
+    typedef          const_iterator                         iterator;
+    typedef          std::reverse_iterator<const_iterator>  reverse_iterator;
+    typedef          std::reverse_iterator<const_iterator>  const_reverse_iterator;
+
+    explicit compact_linear_multiset(const key_compare& comp = key_compare(),
+                                     const allocator_type& alloc = allocator_type())
+    : counts_(comp, alloc)
+    , size_(0)
+    {
+    }
+
+    template <class InputIterator>
+    compact_linear_multiset(InputIterator first, InputIterator last,
+                            const key_compare& comp = key_compare(),
+                            const allocator_type& alloc = allocator_type())
+    : counts_(comp, alloc)
+    , size_(0)
+    {
+        insert(first, last);
+    }
+
+    compact_linear_multiset(std::initializer_list<value_type> il,
+                            const key_compare& comp = key_compare(),
+                            const allocator_type& alloc = allocator_type())
+    : counts_(comp, alloc)
+    , size_(0)
+    {
+        insert(il.begin(), il.end());
+    }
+
+    const_iterator begin() const
+    {
+        return const_iterator(counts_.begin(), 0);
+    }
+
+    const_iterator cbegin() const
+    {
+        return begin();
+    }
+
+    const_iterator end() const
+    {
+        return const_iterator(counts_.end(), 0);
+    }
+
+    const_iterator cend() const
+    {
+        return end();
+    }
+
+    const_reverse_iterator rbegin() const
+    {
+        return const_reverse_iterator(end());
+    }
+
+    const_reverse_iterator crbegin() const
+    {
+        return rbegin();
+    }
+
+    const_reverse_iterator rend() const
+    {
+        return const_reverse_iterator(begin());
+    }
+
+    const_reverse_iterator crend() const
+    {
+        return rend();
+    }
+
+    bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    size_type size() const noexcept
+    {
+        return size_;
+    }
+
+    /**
+     * Number of distinct keys, which is what memory use is proportional to.
+     */
+    size_type distinct_size() const noexcept
+    {
+        return counts_.size();
+    }
+
+    const_iterator insert(const value_type& val, size_type n = 1)
+    {
+        if ( n == 0 )
+        {
+            return lower_bound(val);
+        }
+        typename storage_type::iterator it = counts_.try_emplace(val, 0).first;
+        it->second += n;
+        size_ += n;
+        return const_iterator(it, it->second - 1);
+    }
+
+    template <class InputIterator>
+    void insert(InputIterator first, InputIterator last)
+    {
+        std::vector<value_type> keys(first, last);
+        std::stable_sort(keys.begin(), keys.end(), key_comp());
+        std::vector<std::pair<value_type, size_type> > fresh;
+        for ( typename std::vector<value_type>::iterator it = keys.begin(); it != keys.end(); )
+        {
+            typename std::vector<value_type>::iterator next = std::upper_bound(it, keys.end(), *it, key_comp());
+            size_type n = next - it;
+            typename storage_type::iterator existing = counts_.find(*it);
+            if ( existing != counts_.end() )
+            {
+                existing->second += n;
+            }
+            else
+            {
+                fresh.push_back(std::make_pair(std::move(*it), n));
+            }
+            size_ += n;
+            it = next;
+        }
+        counts_.insert(fresh.begin(), fresh.end());
+    }
+
+    void erase(const_iterator position)
+    {
+        typename storage_type::iterator it = counts_.begin() + (position.it_ - counts_.cbegin());
+        if ( --it->second == 0 )
+        {
+            counts_.erase(it);
+        }
+        --size_;
+    }
+
+    size_type erase(const value_type& val, size_type n = ~size_type(0))
+    {
+        typename storage_type::iterator it = counts_.find(val);
+        if ( it == counts_.end() )
+        {
+            return 0;
+        }
+        n = std::min(n, it->second);
+        it->second -= n;
+        size_ -= n;
+        if ( it->second == 0 )
+        {
+            counts_.erase(it);
+        }
+        return n;
+    }
+
+    void swap(compact_linear_multiset& other)
+    {
+        counts_.swap(other.counts_);
+        std::swap(size_, other.size_);
+    }
+
+    void clear() noexcept
+    {
+        counts_.clear();
+        size_ = 0;
+    }
+
+    const_iterator find(const value_type& val) const
+    {
+        return const_iterator(counts_.find(val), 0);
+    }
+
+    size_type count(const value_type& val) const
+    {
+        typename storage_type::const_iterator it = counts_.find(val);
+        return ( it != counts_.end() ) ? it->second : 0;
+    }
+
+    const_iterator lower_bound(const value_type& val) const
+    {
+        return const_iterator(counts_.lower_bound(val), 0);
+    }
+
+    const_iterator upper_bound(const value_type& val) const
+    {
+        return const_iterator(counts_.upper_bound(val), 0);
+    }
+
+    std::pair<const_iterator, const_iterator> equal_range(const value_type& val) const
+    {
+        return std::make_pair(lower_bound(val), upper_bound(val));
+    }
+
+    key_compare key_comp() const
+    {
+        return counts_.key_comp();
+    }
+
+    value_compare value_comp() const
+    {
+        return counts_.key_comp();
+    }
+
+    allocator_type get_allocator() const
+    {
+        return allocator_type(counts_.get_allocator());
+    }
+
+private:
+    storage_type    counts_;
+    size_type       size_;
+};  // class compact_linear_multiset
+
+}  // namespace eos
+
+#endif  // EOS_LINEAR_MULTISET_H_
@@ -6,10 +6,27 @@
 #ifndef EOS_LINEAR_SET_H_
 #define EOS_LINEAR_SET_H_
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 #include <algorithm>
 #include <functional>
 #include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "eos/detail/algorithm.h"
+#include "eos/detail/batch_search.h"
+#include "eos/detail/file_format.h"
+#include "eos/detail/parallel.h"
+#include "eos/detail/simd_search.h"
+#include "eos/detail/static_search_tree.h"
+#include "eos/growth_policy.h"
+#include "eos/sorted_view.h"
 
 namespace eos
 {
@@ -17,21 +34,26 @@ namespace eos
 template <
     typename Key,
     typename Compare = std::less<Key>,
-    typename Alloc = std::allocator<Key>
+    typename Alloc = std::allocator<Key>,
+    typename Growth = default_growth,
+    typename Storage = std::vector<Key, Alloc>
     >
 class linear_set
 {
-    typedef          std::vector<Key, Alloc>                storage_type;
+    typedef          Storage                                storage_type;
+    typedef          std::allocator_traits<
+        typename storage_type::allocator_type>              alloc_traits;
 public:
+    typedef          Growth                                 growth_policy;
     typedef typename storage_type::value_type               key_type;
     typedef typename storage_type::value_type               value_type;
     typedef          Compare                                key_compare;
     typedef          Compare                                value_compare;
     typedef typename storage_type::allocator_type           allocator_type;
-    typedef typename allocator_type::reference              reference;
-    typedef typename allocator_type::const_reference        const_reference;
-    typedef typename allocator_type::pointer                pointer;
-    typedef typename allocator_type::const_pointer          const_pointer;
+    typedef          value_type&                            reference;
+    typedef          const value_type&                      const_reference;
+    typedef typename alloc_traits::pointer                  pointer;
+    typedef typename alloc_traits::const_pointer            const_pointer;
     typedef typename storage_type::iterator                 iterator;
     typedef typename storage_type::const_iterator           const_iterator;
     typedef typename storage_type::reverse_iterator         reverse_iterator;
@@ -43,6 +65,8 @@ public:
                         const allocator_type& alloc = allocator_type())
     : comp_(comp)
     , storage_(alloc)
+    , pending_(0)
+    , pending_limit_(0)
     {
     }
 
@@ -51,15 +75,53 @@ public:
                const key_compare& comp = key_compare(),
                const allocator_type& alloc = allocator_type())
     : comp_(comp)
-    , storage_(alloc)
+    , storage_(first, last, alloc)
+    , pending_(0)
+    , pending_limit_(0)
     {
-        std::copy(first, last, std::inserter(*this, begin()));
+        sort_unique(begin());
     }
 
     linear_set(const linear_set& other)
     : comp_(other.comp_)
+    , index_(other.index_, alloc_traits::select_on_container_copy_construction(other.get_allocator()))
     , storage_(other.storage_)
+    , pending_(other.pending_)
+    , pending_limit_(other.pending_limit_)
+    {
+    }
+
+    linear_set(const linear_set& other, const allocator_type& alloc)
+    : comp_(other.comp_)
+    , index_(other.index_, alloc)
+    , storage_(other.storage_, alloc)
+    , pending_(other.pending_)
+    , pending_limit_(other.pending_limit_)
+    {
+    }
+
+    linear_set(linear_set&& other)
+        noexcept(std::is_nothrow_move_constructible<storage_type>::value &&
+                 std::is_nothrow_move_constructible<key_compare>::value)
+    : comp_(std::move(other.comp_))
+    , index_(std::move(other.index_))
+    , storage_(std::move(other.storage_))
+    , pending_(other.pending_)
+    , pending_limit_(other.pending_limit_)
     {
+        other.clear();
+    }
+
+    /**
+     * With an allocator unequal to other's the keys are moved one by one.
+     */
+    linear_set(linear_set&& other, const allocator_type& alloc)
+    : comp_(std::move(other.comp_))
+    , storage_(std::move(other.storage_), alloc)
+    , pending_(other.pending_)
+    , pending_limit_(other.pending_limit_)
+    {
+        other.clear();
     }
 
     linear_set(std::initializer_list<value_type> il,
@@ -67,83 +129,144 @@ public:
                const allocator_type& alloc = allocator_type())
     : comp_(comp)
     , storage_(il, alloc)
+    , pending_(0)
+    , pending_limit_(0)
     {
-        std::stable_sort(begin(), end(), comp_);
+        sort_unique(begin());
     }
 
     ~linear_set()
     {
     }
 
+    template <class InputIterator>
+    static linear_set build_parallel(InputIterator first, InputIterator last,
+                                     std::size_t threads = 0,
+                                     const key_compare& comp = key_compare(),
+                                     const allocator_type& alloc = allocator_type())
+    {
+        linear_set result(comp, alloc);
+        storage_type(first, last, alloc).swap(result.storage_);
+        if ( threads == 0 )
+        {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        threads = std::min<std::size_t>(threads, result.size() / parallel_grain);
+        if ( threads > 1 )
+        {
+            detail::parallel_sort_unique(result.storage_, threads, result.comp_);
+        }
+        else
+        {
+            result.sort_unique(result.begin());
+        }
+        return result;
+    }
+
     linear_set& operator=(const linear_set& other)
     {
-        comp_    = other.comp_;
-        storage_ = other.storage_;
+        comp_          = other.comp_;
+        storage_       = other.storage_;
+        pending_       = other.pending_;
+        pending_limit_ = other.pending_limit_;
+        index_.assign(other.index_, get_allocator());
+        return *this;
+    }
+
+    linear_set& operator=(linear_set&& other)
+        noexcept(std::is_nothrow_move_assignable<storage_type>::value &&
+                 std::is_nothrow_move_assignable<key_compare>::value)
+    {
+        if ( this != &other )
+        {
+            comp_          = std::move(other.comp_);
+            storage_       = std::move(other.storage_);
+            pending_       = other.pending_;
+            pending_limit_ = other.pending_limit_;
+            index_         = std::move(other.index_);
+            other.clear();
+        }
+        return *this;
     }
 
     linear_set& operator=(std::initializer_list<value_type> il)
     {
-        storage_type(il).swap(storage_);
-        std::stable_sort(begin(), end(), comp_);
+        storage_type(il, storage_.get_allocator()).swap(storage_);
+        pending_ = 0;
+        index_.invalidate();
+        sort_unique(begin());
+        return *this;
     }
 
-    iterator begin() noexcept
+    iterator begin()
     {
+        consolidate();
         return storage_.begin();
     }
 
-    const_iterator begin() const noexcept
+    const_iterator begin() const
     {
+        consolidate();
         return storage_.begin();
     }
 
-    const_iterator cbegin() const noexcept
+    const_iterator cbegin() const
     {
+        consolidate();
         return storage_.begin();
     }
 
-    iterator end() noexcept
+    iterator end()
     {
+        consolidate();
         return storage_.end();
     }
 
-    const_iterator end() const noexcept
+    const_iterator end() const
     {
+        consolidate();
         return storage_.end();
     }
 
-    const_iterator cend() const noexcept
+    const_iterator cend() const
     {
+        consolidate();
         return storage_.end();
     }
 
-    reverse_iterator rbegin() noexcept
+    reverse_iterator rbegin()
     {
+        consolidate();
         return storage_.rbegin();
     }
 
-    const_reverse_iterator rbegin() const noexcept
+    const_reverse_iterator rbegin() const
     {
+        consolidate();
         return storage_.rbegin();
     }
 
-    const_reverse_iterator crbegin() const noexcept
+    const_reverse_iterator crbegin() const
     {
+        consolidate();
         return storage_.crbegin();
     }
 
-    reverse_iterator rend() noexcept
+    reverse_iterator rend()
     {
+        consolidate();
         return storage_.rend();
     }
 
-    const_reverse_iterator rend() const noexcept
+    const_reverse_iterator rend() const
     {
+        consolidate();
         return storage_.rend();
     }
 
-    const_reverse_iterator crend() const noexcept
+    const_reverse_iterator crend() const
     {
+        consolidate();
         return storage_.crend();
     }
 
@@ -152,8 +275,12 @@ public:
         return storage_.empty();
     }
 
-    size_type size() const noexcept
+    /**
+     * Merges pending inserts first, since the tail may repeat a key.
+     */
+    size_type size() const
     {
+        consolidate();
         return storage_.size();
     }
 
@@ -162,48 +289,68 @@ public:
         return storage_.max_size();
     }
 
+    size_type capacity() const noexcept
+    {
+        return storage_.capacity();
+    }
+
+    void reserve(size_type n)
+    {
+        storage_.reserve(n);
+    }
+
+    void shrink_to_fit()
+    {
+        storage_.shrink_to_fit();
+    }
+
     std::pair<iterator, bool> insert(const value_type& val)
     {
-        iterator it = lower_bound(val);
-        if ( it == end() )
-        {
-            storage_.push_back(val);
-            return std::make_pair(--end(), true);
-        }
-        if ( !comp_(val, *it) )
-        {
-            return std::make_pair(it, false);
-        }
-        else
-        {
-            it = insert_at(it, val);
-            return std::make_pair(it, true);
-        }
+        return insert_unique(val);
+    }
+
+    std::pair<iterator, bool> insert(value_type&& val)
+    {
+        return insert_unique(std::move(val));
     }
 
     iterator insert(iterator position, const value_type& val)
     {
-        position = insert_at(position, val);
-        std::stable_sort(begin(), end(), comp_);
-        if ( *position == val )
-        {
-            return position;
-        }
-        else
-        {
-            return find(val);
-        }
+        return insert_hint(position, val);
+    }
+
+    iterator insert(iterator position, value_type&& val)
+    {
+        return insert_hint(position, std::move(val));
     }
 
     template <class InputIterator>
     void insert(InputIterator first, InputIterator last)
     {
-        std::copy(first, last, std::inserter(*this, begin()));
+        consolidate();
+        size_type count = size();
+        index_.invalidate();
+        grow(first, last, typename std::iterator_traits<InputIterator>::iterator_category());
+        storage_.insert(end(), first, last);
+        sort_unique(begin() + count);
+        merge_unique(begin() + count);
+    }
+
+    template <class... Args>
+    std::pair<iterator, bool> emplace(Args&&... args)
+    {
+        return insert_unique(value_type(std::forward<Args>(args)...));
+    }
+
+    template <class... Args>
+    iterator emplace_hint(iterator position, Args&&... args)
+    {
+        return insert(position, value_type(std::forward<Args>(args)...));
     }
 
     void erase(iterator position)
     {
-        storage_.erase(position);
+        erase(position, position + 1);
     }
 
     size_type erase(const value_type& val)
@@ -220,25 +367,195 @@ public:
         }
     }
 
+    template <class K, class C = Compare, class = typename C::is_transparent,
+              class = typename std::enable_if<!std::is_convertible<K, iterator>::value>::type>
+    size_type erase(const K& key)
+    {
+        std::pair<iterator, iterator> range = equal_range(key);
+        size_type count = std::distance(range.first, range.second);
+        erase(range.first, range.second);
+        return count;
+    }
+
     void erase(iterator first, iterator last)
     {
+        iterator middle = storage_.end() - pending_;
+        pending_ -= std::distance(std::max(first, middle), std::max(last, middle));
+        index_.invalidate();
         storage_.erase(first, last);
     }
 
+    template <class ForwardIterator>
+    size_type erase_keys(ForwardIterator first, ForwardIterator last)
+    {
+        iterator out = begin(), first1 = begin(), last1 = end();
+        size_type count = std::distance(first, last);
+        bool gallop1 = detail::should_gallop(size(), count);
+        bool gallop2 = detail::should_gallop(count, size());
+        while ( first1 != last1 && first != last )
+        {
+            if ( comp_(*first1, *first) )
+            {
+                iterator next = gallop1 ? detail::gallop_lower_bound(first1, last1, *first, comp_) : first1 + 1;
+                out = ( out == first1 ) ? next : std::move(first1, next, out);
+                first1 = next;
+            }
+            else if ( comp_(*first, *first1) )
+            {
+                first = detail::skip_less(first, last, *first1, comp_, gallop2);
+            }
+            else
+            {
+                ++first1;
+                ++first;
+            }
+        }
+        out = ( out == first1 ) ? last1 : std::move(first1, last1, out);
+        count = last1 - out;
+        erase(out, last1);
+        return count;
+    }
+
+    /**
+     * Swaps allocators only if they propagate on swap; otherwise they must
+     * compare equal.
+     */
     void swap(linear_set& other)
     {
+        using std::swap;
+        swap(comp_, other.comp_);
         storage_.swap(other.storage_);
+        std::swap(pending_, other.pending_);
+        std::swap(pending_limit_, other.pending_limit_);
+        index_.swap(other.index_);
     }
 
     void clear()
     {
         storage_.clear();
+        pending_ = 0;
+        index_.invalidate();
+    }
+
+    linear_set& operator|=(const linear_set& other)
+    {
+        if ( &other != this )
+        {
+            insert(other.begin(), other.end());
+        }
+        return *this;
+    }
+
+    linear_set& operator&=(const linear_set& other)
+    {
+        iterator out = begin(), first1 = begin(), last1 = end();
+        const_iterator first2 = other.begin(), last2 = other.end();
+        bool gallop1 = detail::should_gallop(size(), other.size());
+        bool gallop2 = detail::should_gallop(other.size(), size());
+        while ( first1 != last1 && first2 != last2 )
+        {
+            if ( comp_(*first1, *first2) )
+            {
+                first1 = gallop1 ? detail::gallop_lower_bound(first1, last1, *first2, comp_) : first1 + 1;
+            }
+            else if ( comp_(*first2, *first1) )
+            {
+                first2 = gallop2 ? detail::gallop_lower_bound(first2, last2, *first1, comp_) : first2 + 1;
+            }
+            else
+            {
+                if ( out != first1 )
+                {
+                    *out = std::move(*first1);
+                }
+                ++out;
+                ++first1;
+                ++first2;
+            }
+        }
+        erase(out, end());
+        return *this;
+    }
+
+    linear_set& operator-=(const linear_set& other)
+    {
+        erase_keys(other.begin(), other.end());
+        return *this;
+    }
+
+    linear_set& operator^=(const linear_set& other)
+    {
+        storage_type result(storage_.get_allocator());
+        result.reserve(size() + other.size());
+        std::set_symmetric_difference(std::make_move_iterator(begin()), std::make_move_iterator(end()),
+                                      other.begin(), other.end(),
+                                      std::back_inserter(result), comp_);
+        storage_.swap(result);
+        index_.invalidate();
+        return *this;
+    }
+
+    /**
+     * With a non-zero limit, inserts append to an unsorted tail of at most
+     * limit keys after a binary search of the sorted body; the tail is
+     * sorted and merged into the body when it fills up or on the next
+     * ordered access (iteration, size, bounds), const ones included. Inserts
+     * scan the tail, so duplicates are still reported as not inserted. An
+     * iterator returned by such an insert is valid only until that merge.
+     * find and count on a const set, heterogeneous overloads included,
+     * search the body and scan the tail without merging, so concurrent const
+     * finds stay safe; any
+     * other concurrent const access to a set with pending() keys is a data
+     * race. A limit of zero merges the tail and switches back to sorted
+     * inserts.
+     */
+    void defer_sort(size_type limit)
+    {
+        pending_limit_ = limit;
+        if ( limit == 0 )
+        {
+            consolidate();
+        }
+    }
+
+    size_type pending() const noexcept
+    {
+        return pending_;
+    }
+
+    void consolidate() const
+    {
+        if ( pending_ != 0 )
+        {
+            size_type body = storage_.size() - pending_;
+            storage_.erase(detail::sort_unique(storage_.begin() + body, storage_.end(), comp_), storage_.end());
+            storage_.erase(detail::merge_unique(storage_.begin(), storage_.begin() + body, storage_.end(), comp_),
+                           storage_.end());
+            pending_ = 0;
+        }
+    }
+
+    /**
+     * Builds a static 16-ary index of separator keys over the sorted
+     * storage, which then stays a plain sorted array. lower_bound, find and
+     * count descend it with one SIMD count per level. Every modification
+     * drops the index; call build_index again to restore it.
+     */
+    void build_index()
+    {
+        static_assert(searchable::value, "build_index needs arithmetic keys ordered by std::less");
+        index_.build(data(), size(), get_allocator());
+    }
+
+    bool has_index() const noexcept
+    {
+        return index_.valid();
     }
 
     iterator find(const value_type& val)
     {
         iterator it = lower_bound(val);
-        if ( it != end() && !(val < *it) )
+        if ( it != end() && !comp_(val, *it) )
         {
             return it;
         }
@@ -247,11 +564,47 @@ public:
             return end();
         }
     }
-    
+
     const_iterator find(const value_type& val) const
     {
+        if ( pending_ != 0 )
+        {
+            return find_deferred(val);
+        }
         const_iterator it = lower_bound(val);
-        if ( it != end() && !(val < *it) )
+        if ( it != end() && !comp_(val, *it) )
+        {
+            return it;
+        }
+        else
+        {
+            return end();
+        }
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    iterator find(const K& key)
+    {
+        iterator it = lower_bound(key);
+        if ( it != end() && !comp_(key, *it) )
+        {
+            return it;
+        }
+        else
+        {
+            return end();
+        }
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    const_iterator find(const K& key) const
+    {
+        if ( pending_ != 0 )
+        {
+            return find_deferred(key);
+        }
+        const_iterator it = lower_bound(key);
+        if ( it != end() && !comp_(key, *it) )
         {
             return it;
         }
@@ -263,7 +616,66 @@ public:
 
     size_type count(const value_type& val) const
     {
-        return ( find(val) != end() ) ? 1 : 0;
+        const storage_type& storage = storage_;
+        return ( find(val) != storage.end() ) ? 1 : 0;
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    size_type count(const K& key) const
+    {
+        if ( pending_ != 0 )
+        {
+            return count_deferred(key);
+        }
+        std::pair<const_iterator, const_iterator> range = equal_range(key);
+        return std::distance(range.first, range.second);
+    }
+
+    /**
+     * Writes find(key) for every query, in query order. Interleaves the
+     * searches to overlap their cache misses, which pays off on unsorted
+     * batches against sets larger than the cache.
+     */
+    template <class ForwardIterator, class OutputIterator>
+    OutputIterator find_many(ForwardIterator first, ForwardIterator last, OutputIterator out) const
+    {
+        const_iterator begin = this->begin(), end = this->end();
+        const key_compare& comp = comp_;
+        detail::batch_lower_bound(begin, end, first, last, comp_,
+                                  [&](const value_type& val, const_iterator it)
+        {
+            *out = ( it != end && !comp(val, *it) ) ? it : end;
+            ++out;
+        });
+        return out;
+    }
+
+    /**
+     * Sets bit i % 64 of mask[i / 64] to whether the i-th query is present
+     * and returns how many are; mask needs room for every query.
+     */
+    template <class ForwardIterator>
+    size_type contains_many(ForwardIterator first, ForwardIterator last, std::uint64_t* mask) const
+    {
+        const_iterator end = this->end();
+        const key_compare& comp = comp_;
+        size_type index = 0, found = 0;
+        detail::batch_lower_bound(begin(), end, first, last, comp_,
+                                  [&](const value_type& val, const_iterator it)
+        {
+            std::uint64_t bit = std::uint64_t(1) << (index % 64);
+            if ( index % 64 == 0 )
+            {
+                mask[index / 64] = 0;
+            }
+            if ( it != end && !comp(val, *it) )
+            {
+                mask[index / 64] |= bit;
+                ++found;
+            }
+            ++index;
+        });
+        return found;
     }
 
     key_compare key_comp() const
@@ -278,12 +690,24 @@ public:
 
     iterator lower_bound(const value_type& val)
     {
-        return std::lower_bound(begin(), end(), val, comp_);
+        return begin() + lower_bound_index(val, searchable());
     }
 
     const_iterator lower_bound(const value_type& val) const
     {
-        return std::lower_bound(begin(), end(), val, comp_);
+        return begin() + lower_bound_index(val, searchable());
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    iterator lower_bound(const K& key)
+    {
+        return std::lower_bound(begin(), end(), key, comp_);
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    const_iterator lower_bound(const K& key) const
+    {
+        return std::lower_bound(begin(), end(), key, comp_);
     }
 
     iterator upper_bound(const value_type& val)
@@ -296,6 +720,18 @@ public:
         return std::upper_bound(begin(), end(), val, comp_);
     }
 
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    iterator upper_bound(const K& key)
+    {
+        return std::upper_bound(begin(), end(), key, comp_);
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    const_iterator upper_bound(const K& key) const
+    {
+        return std::upper_bound(begin(), end(), key, comp_);
+    }
+
     std::pair<iterator, iterator> equal_range(const value_type& val)
     {
         return std::equal_range(begin(), end(), val, comp_);
@@ -306,27 +742,314 @@ public:
         return std::equal_range(begin(), end(), val, comp_);
     }
 
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    std::pair<iterator, iterator> equal_range(const K& key)
+    {
+        return std::equal_range(begin(), end(), key, comp_);
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    std::pair<const_iterator, const_iterator> equal_range(const K& key) const
+    {
+        return std::equal_range(begin(), end(), key, comp_);
+    }
+
     allocator_type get_allocator() const
     {
         return storage_.get_allocator();
     }
 
+    const value_type* data() const
+    {
+        consolidate();
+        return empty() ? nullptr : &*storage_.begin();
+    }
+
+    /**
+     * Non-owning view of the keys, valid until the set is next modified.
+     */
+    sorted_view<Key, Compare> view() const
+    {
+        return sorted_view<Key, Compare>(data(), size(), comp_);
+    }
+
+    /**
+     * Writes the keys in the format described in eos/detail/file_format.h,
+     * ready to be opened with mapped_linear_set.
+     */
+    void save(const std::string& path) const
+    {
+        static_assert(std::is_trivially_copyable<Key>::value,
+                      "linear_set::save requires trivially copyable keys");
+        detail::write_sorted_file(path, data(), size());
+    }
+
 private:
-    iterator insert_at(iterator position, const value_type& val)
+    template <class K, class... Params>
+    friend linear_set<K, Params...> set_intersection(const linear_set<K, Params...>& lhs,
+                                                     const linear_set<K, Params...>& rhs);
+
+    template <class K, class... Params>
+    friend linear_set<K, Params...> set_difference(const linear_set<K, Params...>& lhs,
+                                                   const linear_set<K, Params...>& rhs);
+
+    typedef          detail::is_simd_searchable<
+        value_type, Compare>                                searchable;
+
+    static const std::size_t parallel_grain = 16384;
+
+    void sort_unique(iterator first)
+    {
+        storage_.erase(detail::sort_unique(first, end(), comp_), end());
+    }
+
+    void merge_unique(iterator middle)
+    {
+        storage_.erase(detail::merge_unique(begin(), middle, end(), comp_), end());
+    }
+
+    template <class V>
+    std::pair<iterator, bool> insert_unique(V&& val)
+    {
+        if ( pending_limit_ != 0 )
+        {
+            return insert_deferred(std::forward<V>(val));
+        }
+        iterator it = lower_bound(val);
+        if ( it != end() && !comp_(val, *it) )
+        {
+            return std::make_pair(it, false);
+        }
+        else
+        {
+            return std::make_pair(insert_at(it, std::forward<V>(val)), true);
+        }
+    }
+
+    template <class V>
+    std::pair<iterator, bool> insert_deferred(V&& val)
     {
-        difference_type count = std::distance(begin(), position);
-        storage_.emplace_back();
-        position = begin();
-        std::advance(position, count);
-        std::copy_backward(position, --end(), end());
-        *position = val;
-        return position;
+        if ( pending_ >= pending_limit_ )
+        {
+            consolidate();
+        }
+        const storage_type& storage = storage_;
+        const_iterator found = find_deferred(val);
+        if ( found != storage.end() )
+        {
+            return std::make_pair(storage_.begin() + (found - storage.begin()), false);
+        }
+        grow(1);
+        index_.invalidate();
+        storage_.push_back(std::forward<V>(val));
+        ++pending_;
+        return std::make_pair(storage_.end() - 1, true);
     }
 
-    key_compare     comp_;
-    storage_type    storage_;
+    /**
+     * Searches the sorted body and scans the unsorted tail, which holds at
+     * most pending_limit_ keys, without merging them.
+     */
+    template <class K>
+    const_iterator find_deferred(const K& key) const
+    {
+        const storage_type& storage = storage_;
+        const_iterator middle = storage.end() - pending_;
+        const_iterator it = detail::fast_lower_bound(storage.begin(), middle, key, comp_);
+        if ( it != middle && !comp_(key, *it) )
+        {
+            return it;
+        }
+        for ( it = middle; it != storage.end(); ++it )
+        {
+            if ( !comp_(key, *it) && !comp_(*it, key) )
+            {
+                return it;
+            }
+        }
+        return storage.end();
+    }
+
+    template <class K>
+    size_type count_deferred(const K& key) const
+    {
+        const storage_type& storage = storage_;
+        const_iterator middle = storage.end() - pending_;
+        std::pair<const_iterator, const_iterator> range = std::equal_range(storage.begin(), middle, key, comp_);
+        size_type result = std::distance(range.first, range.second);
+        for ( const_iterator it = middle; it != storage.end(); ++it )
+        {
+            if ( !comp_(key, *it) && !comp_(*it, key) )
+            {
+                ++result;
+            }
+        }
+        return result;
+    }
+
+    template <class V>
+    iterator insert_hint(iterator position, V&& val)
+    {
+        if ( pending_limit_ != 0 )
+        {
+            return insert_deferred(std::forward<V>(val)).first;
+        }
+        if ( position == end() || comp_(val, *position) )
+        {
+            if ( position == begin() || comp_(*(position - 1), val) )
+            {
+                return insert_at(position, std::forward<V>(val));
+            }
+            position = detail::gallop_lower_bound_backward(begin(), position, val, comp_);
+        }
+        else
+        {
+            position = detail::gallop_lower_bound(position, end(), val, comp_);
+        }
+        if ( position != end() && !comp_(val, *position) )
+        {
+            return position;
+        }
+        else
+        {
+            return insert_at(position, std::forward<V>(val));
+        }
+    }
+
+    template <class V>
+    iterator insert_at(iterator position, V&& val)
+    {
+        difference_type index = position - storage_.begin();
+        grow(1);
+        index_.invalidate();
+        return storage_.insert(storage_.begin() + index, std::forward<V>(val));
+    }
+
+    void grow(size_type count)
+    {
+        size_type required = storage_.size() + count;
+        if ( required > storage_.capacity() )
+        {
+            storage_.reserve(growth_policy::next_capacity(storage_.capacity(), required));
+        }
+    }
+
+    template <class ForwardIterator>
+    void grow(ForwardIterator first, ForwardIterator last, std::forward_iterator_tag)
+    {
+        grow(std::distance(first, last));
+    }
+
+    template <class InputIterator>
+    void grow(InputIterator, InputIterator, std::input_iterator_tag)
+    {
+    }
+
+    size_type lower_bound_index(const value_type& val, std::true_type) const
+    {
+        if ( index_.valid() )
+        {
+            return index_.lower_bound(data(), val);
+        }
+        return detail::fast_lower_bound(begin(), end(), val, comp_) - begin();
+    }
+
+    size_type lower_bound_index(const value_type& val, std::false_type) const
+    {
+        return detail::fast_lower_bound(begin(), end(), val, comp_) - begin();
+    }
+
+    key_compare                                                 comp_;
+    detail::search_tree_handle<
+        value_type, allocator_type, searchable::value>          index_;
+    mutable storage_type                                        storage_;
+    mutable size_type                                           pending_;
+    size_type                                                   pending_limit_;
 };  // class linear_set
 
+template <class Key, class... Params, class Predicate>
+typename linear_set<Key, Params...>::size_type erase_if(linear_set<Key, Params...>& set, Predicate pred)
+{
+    typename linear_set<Key, Params...>::iterator it = std::remove_if(set.begin(), set.end(), pred);
+    typename linear_set<Key, Params...>::size_type count = std::distance(it, set.end());
+    set.erase(it, set.end());
+    return count;
+}
+
+template <class Key, class... Params>
+void swap(linear_set<Key, Params...>& lhs, linear_set<Key, Params...>& rhs)
+{
+    lhs.swap(rhs);
+}
+
+template <class Key, class... Params>
+linear_set<Key, Params...> set_union(const linear_set<Key, Params...>& lhs,
+                                     const linear_set<Key, Params...>& rhs)
+{
+    linear_set<Key, Params...> result(lhs);
+    result |= rhs;
+    return result;
+}
+
+template <class Key, class... Params>
+linear_set<Key, Params...> set_intersection(const linear_set<Key, Params...>& lhs,
+                                            const linear_set<Key, Params...>& rhs)
+{
+    linear_set<Key, Params...> result(lhs.key_comp(), lhs.get_allocator());
+    result.storage_.reserve(std::min(lhs.size(), rhs.size()));
+    detail::gallop_set_intersection(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                                    std::back_inserter(result.storage_), lhs.key_comp());
+    return result;
+}
+
+template <class Key, class... Params>
+linear_set<Key, Params...> set_difference(const linear_set<Key, Params...>& lhs,
+                                          const linear_set<Key, Params...>& rhs)
+{
+    linear_set<Key, Params...> result(lhs.key_comp(), lhs.get_allocator());
+    result.storage_.reserve(lhs.size());
+    detail::gallop_set_difference(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                                  std::back_inserter(result.storage_), lhs.key_comp());
+    return result;
+}
+
+template <class Key, class... Params>
+linear_set<Key, Params...> set_symmetric_difference(const linear_set<Key, Params...>& lhs,
+                                                    const linear_set<Key, Params...>& rhs)
+{
+    linear_set<Key, Params...> result(lhs);
+    result ^= rhs;
+    return result;
+}
+
+template <class Key, class... Params>
+linear_set<Key, Params...> operator|(const linear_set<Key, Params...>& lhs,
+                                     const linear_set<Key, Params...>& rhs)
+{
+    return set_union(lhs, rhs);
+}
+
+template <class Key, class... Params>
+linear_set<Key, Params...> operator&(const linear_set<Key, Params...>& lhs,
+                                     const linear_set<Key, Params...>& rhs)
+{
+    return set_intersection(lhs, rhs);
+}
+
+template <class Key, class... Params>
+linear_set<Key, Params...> operator-(const linear_set<Key, Params...>& lhs,
+                                     const linear_set<Key, Params...>& rhs)
+{
+    return set_difference(lhs, rhs);
+}
+
+template <class Key, class... Params>
+linear_set<Key, Params...> operator^(const linear_set<Key, Params...>& lhs,
+                                     const linear_set<Key, Params...>& rhs)
+{
+    return set_symmetric_difference(lhs, rhs);
+}
+
 }  // namespace eos
 
 #endif  // EOS_LINEAR_SET_H_
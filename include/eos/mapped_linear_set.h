@@ -0,0 +1,288 @@
+/**
+ * @author Gracjan Olbinski <gracjan.olbinski@gmail.com>
+ */
+
+
+#ifndef EOS_MAPPED_LINEAR_SET_H_
+#define EOS_MAPPED_LINEAR_SET_H_
+
+#include <cerrno>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "eos/detail/file_format.h"
+#include "eos/sorted_view.h"
+
+namespace eos
+{
+
+/**
+ * Read-only set over a file written by linear_set::save. The file is mapped
+ * shared and read-only, so opening it costs a header check and every process
+ * mapping the same file shares its page cache. Keys are used in place; the
+ * checksum is only computed when verify() is called.
+ */
+template <
+    typename Key,
+    typename Compare = std::less<Key>
+    >
+class mapped_linear_set
+{
+    static_assert(std::is_trivially_copyable<Key>::value,
+                  "mapped_linear_set requires trivially copyable keys");
+public:
+    typedef          Key                                    key_type;
+    typedef          Key                                    value_type;
+    typedef          Compare                                key_compare;
+    typedef          Compare                                value_compare;
+    typedef          const value_type&                      reference;
+    typedef          const value_type&                      const_reference;
+    typedef          const value_type*                      pointer;
+    typedef          const value_type*                      const_pointer;
+    typedef          const value_type*                      iterator;
+    typedef          const value_type*                      const_iterator;
+    typedef          std::reverse_iterator<const_iterator>  reverse_iterator;
+    typedef          std::reverse_iterator<const_iterator>  const_reverse_iterator;
+    typedef          std::ptrdiff_t                         difference_type;
+    typedef          std::size_t                            size_type;
+
+    explicit mapped_linear_set(const std::string& path,
+                               const key_compare& comp = key_compare())
+    : view_(comp)
+    , map_(nullptr)
+    , map_size_(0)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if ( fd < 0 )
+        {
+            throw std::system_error(errno, std::generic_category(), "eos: cannot open " + path);
+        }
+        struct stat info;
+        if ( ::fstat(fd, &info) != 0 )
+        {
+            int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "eos: cannot stat " + path);
+        }
+        if ( static_cast<std::size_t>(info.st_size) < sizeof(detail::file_header) )
+        {
+            ::close(fd);
+            throw std::runtime_error("eos: not a linear_set file: " + path);
+        }
+        void* map = ::mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        int error = errno;
+        ::close(fd);
+        if ( map == MAP_FAILED )
+        {
+            throw std::system_error(error, std::generic_category(), "eos: cannot map " + path);
+        }
+        map_ = map;
+        map_size_ = info.st_size;
+        try
+        {
+            detail::check_file_header<Key>(header(), map_size_, path);
+        }
+        catch ( ... )
+        {
+            ::munmap(map_, map_size_);
+            throw;
+        }
+        view_ = sorted_view<Key, Compare>(
+            reinterpret_cast<const value_type*>(static_cast<const char*>(map_) + sizeof(detail::file_header)),
+            header().count, comp);
+    }
+
+    mapped_linear_set(mapped_linear_set&& other) noexcept
+    : view_(other.view_)
+    , map_(other.map_)
+    , map_size_(other.map_size_)
+    {
+        other.view_ = sorted_view<Key, Compare>(other.view_.key_comp());
+        other.map_ = nullptr;
+        other.map_size_ = 0;
+    }
+
+    mapped_linear_set(const mapped_linear_set&) = delete;
+
+    ~mapped_linear_set()
+    {
+        if ( map_ != nullptr )
+        {
+            ::munmap(map_, map_size_);
+        }
+    }
+
+    mapped_linear_set& operator=(mapped_linear_set&& other) noexcept
+    {
+        mapped_linear_set(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    mapped_linear_set& operator=(const mapped_linear_set&) = delete;
+
+    const_iterator begin() const noexcept
+    {
+        return view_.begin();
+    }
+
+    const_iterator cbegin() const noexcept
+    {
+        return view_.begin();
+    }
+
+    const_iterator end() const noexcept
+    {
+        return view_.end();
+    }
+
+    const_iterator cend() const noexcept
+    {
+        return view_.end();
+    }
+
+    const_reverse_iterator rbegin() const noexcept
+    {
+        return const_reverse_iterator(end());
+    }
+
+    const_reverse_iterator crbegin() const noexcept
+    {
+        return rbegin();
+    }
+
+    const_reverse_iterator rend() const noexcept
+    {
+        return const_reverse_iterator(begin());
+    }
+
+    const_reverse_iterator crend() const noexcept
+    {
+        return rend();
+    }
+
+    bool empty() const noexcept
+    {
+        return view_.empty();
+    }
+
+    size_type size() const noexcept
+    {
+        return view_.size();
+    }
+
+    const value_type* data() const noexcept
+    {
+        return view_.data();
+    }
+
+    const sorted_view<Key, Compare>& view() const noexcept
+    {
+        return view_;
+    }
+
+    void swap(mapped_linear_set& other) noexcept
+    {
+        std::swap(view_, other.view_);
+        std::swap(map_, other.map_);
+        std::swap(map_size_, other.map_size_);
+    }
+
+    /**
+     * Recomputes the checksum of the mapped keys; touches every page.
+     */
+    bool verify() const
+    {
+        return map_ != nullptr &&
+               detail::fnv1a64(view_.data(), view_.size() * sizeof(value_type)) == header().checksum;
+    }
+
+    const_iterator find(const value_type& val) const
+    {
+        return view_.find(val);
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    const_iterator find(const K& key) const
+    {
+        return view_.find(key);
+    }
+
+    size_type count(const value_type& val) const
+    {
+        return view_.count(val);
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    size_type count(const K& key) const
+    {
+        return view_.count(key);
+    }
+
+    const_iterator lower_bound(const value_type& val) const
+    {
+        return view_.lower_bound(val);
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    const_iterator lower_bound(const K& key) const
+    {
+        return view_.lower_bound(key);
+    }
+
+    const_iterator upper_bound(const value_type& val) const
+    {
+        return view_.upper_bound(val);
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    const_iterator upper_bound(const K& key) const
+    {
+        return view_.upper_bound(key);
+    }
+
+    std::pair<const_iterator, const_iterator> equal_range(const value_type& val) const
+    {
+        return view_.equal_range(val);
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    std::pair<const_iterator, const_iterator> equal_range(const K& key) const
+    {
+        return view_.equal_range(key);
+    }
+
+    key_compare key_comp() const
+    {
+        return view_.key_comp();
+    }
+
+    value_compare value_comp() const
+    {
+        return view_.value_comp();
+    }
+
+private:
+    const detail::file_header& header() const
+    {
+        return *static_cast<const detail::file_header*>(map_);
+    }
+
+    sorted_view<Key, Compare>   view_;
+    void*                       map_;
+    size_type                   map_size_;
+};  // class mapped_linear_set
+
+}  // namespace eos
+
+#endif  // EOS_MAPPED_LINEAR_SET_H_
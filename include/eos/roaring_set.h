@@ -0,0 +1,815 @@
+/**
+ * @author Gracjan Olbinski <gracjan.olbinski@gmail.com>
+ */
+
+
+#ifndef EOS_ROARING_SET_H_
+#define EOS_ROARING_SET_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+
+#include "eos/linear_set.h"
+#include "eos/detail/platform.h"
+
+namespace eos
+{
+
+/**
+ * Set of 32-bit keys split into chunks by their high 16 bits. Each chunk
+ * keeps the low halves in whichever of three containers is smallest for its
+ * contents: a sorted array (up to 4096 keys), a 65536-bit bitmap, or a list
+ * of [first, last] runs. Single inserts and erases only switch between array
+ * and bitmap; bulk builds and set operations also consider runs.
+ */
+class roaring_set
+{
+    enum chunk_kind
+    {
+        array_chunk,
+        bitmap_chunk,
+        run_chunk
+    };
+
+    struct chunk
+    {
+        std::uint16_t               key;
+        chunk_kind                  kind;
+        std::uint32_t               cardinality;
+        std::vector<std::uint16_t>  values;
+        std::vector<std::uint64_t>  bits;
+    };
+public:
+    typedef          std::uint32_t                          key_type;
+    typedef          std::uint32_t                          value_type;
+    typedef          std::less<std::uint32_t>               key_compare;
+    typedef          std::less<std::uint32_t>               value_compare;
+    typedef          value_type                             reference;
+    typedef          value_type                             const_reference;
+    typedef          std::ptrdiff_t                         difference_type;
+    typedef          std::size_t                            size_type;
+
+    class const_iterator
+    {
+    public:
+        typedef std::forward_iterator_tag                   iterator_category;
+        typedef roaring_set::value_type                     value_type;
+        typedef roaring_set::difference_type                difference_type;
+        typedef const value_type*                           pointer;
+        typedef value_type                                  reference;
+
+        const_iterator() noexcept
+        : set_(nullptr)
+        , chunk_(0)
+        , index_(0)
+        , low_(0)
+        {
+        }
+
+        reference operator*() const
+        {
+            return (static_cast<value_type>(set_->chunks_[chunk_].key) << 16) | low_;
+        }
+
+        const_iterator& operator++()
+        {
+            set_->advance(*this);
+            return *this;
+        }
+
+        const_iterator operator++(int)
+        {
+            const_iterator tmp(*this);
+            ++*this;
+            return tmp;
+        }
+
+        bool operator==(const const_iterator& other) const
+        {
+            return chunk_ == other.chunk_ && low_ == other.low_;
+        }
+
+        bool operator!=(const const_iterator& other) const
+        {
+            return !(*this == other);
+        }
+
+    private:
+        friend class roaring_set;
+
+        const_iterator(const roaring_set* set, size_type chunk, size_type index, std::uint32_t low) noexcept
+        : set_(set)
+        , chunk_(chunk)
+        , index_(index)
+        , low_(low)
+        {
+        }
+
+        const roaring_set*  set_;
+        size_type           chunk_;
+        size_type           index_;
+        std::uint32_t       low_;
+    };  // class const_iterator
+
+    typedef          const_iterator                         iterator;
+
+    roaring_set()
+    : size_(0)
+    {
+    }
+
+    template <class InputIterator>
+    roaring_set(InputIterator first, InputIterator last)
+    : size_(0)
+    {
+        std::vector<value_type> keys(first, last);
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        build(keys.begin(), keys.end());
+    }
+
+    roaring_set(std::initializer_list<value_type> il)
+    : size_(0)
+    {
+        std::vector<value_type> keys(il);
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        build(keys.begin(), keys.end());
+    }
+
+    template <class... Params>
+    explicit roaring_set(const linear_set<value_type, key_compare, Params...>& set)
+    : size_(0)
+    {
+        build(set.begin(), set.end());
+    }
+
+    const_iterator begin() const
+    {
+        return first_of(0);
+    }
+
+    const_iterator cbegin() const
+    {
+        return begin();
+    }
+
+    const_iterator end() const noexcept
+    {
+        return const_iterator(this, chunks_.size(), 0, 0);
+    }
+
+    const_iterator cend() const noexcept
+    {
+        return end();
+    }
+
+    bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    size_type size() const noexcept
+    {
+        return size_;
+    }
+
+    std::pair<iterator, bool> insert(value_type val)
+    {
+        std::uint16_t low = static_cast<std::uint16_t>(val);
+        std::vector<chunk>::iterator it = find_chunk(val);
+        if ( it == chunks_.end() || it->key != (val >> 16) )
+        {
+            chunk fresh;
+            fresh.key = static_cast<std::uint16_t>(val >> 16);
+            fresh.kind = array_chunk;
+            fresh.cardinality = 1;
+            fresh.values.push_back(low);
+            chunks_.insert(it, std::move(fresh));
+        }
+        else if ( chunk_contains(*it, low) )
+        {
+            return std::make_pair(find(val), false);
+        }
+        else
+        {
+            bool was_run = ( it->kind == run_chunk );
+            widen(*it);
+            if ( it->kind == array_chunk )
+            {
+                it->values.insert(std::lower_bound(it->values.begin(), it->values.end(), low), low);
+            }
+            else
+            {
+                it->bits[low / 64] |= std::uint64_t(1) << (low % 64);
+            }
+            ++it->cardinality;
+            normalize(*it, was_run);
+        }
+        ++size_;
+        return std::make_pair(find(val), true);
+    }
+
+    template <class InputIterator>
+    void insert(InputIterator first, InputIterator last)
+    {
+        *this |= roaring_set(first, last);
+    }
+
+    size_type erase(value_type val)
+    {
+        std::uint16_t low = static_cast<std::uint16_t>(val);
+        std::vector<chunk>::iterator it = find_chunk(val);
+        if ( it == chunks_.end() || it->key != (val >> 16) || !chunk_contains(*it, low) )
+        {
+            return 0;
+        }
+        if ( it->cardinality == 1 )
+        {
+            chunks_.erase(it);
+        }
+        else
+        {
+            bool was_run = ( it->kind == run_chunk );
+            if ( was_run )
+            {
+                force_bitmap(*it);
+            }
+            if ( it->kind == array_chunk )
+            {
+                it->values.erase(std::lower_bound(it->values.begin(), it->values.end(), low));
+            }
+            else
+            {
+                it->bits[low / 64] &= ~(std::uint64_t(1) << (low % 64));
+            }
+            --it->cardinality;
+            normalize(*it, was_run);
+        }
+        --size_;
+        return 1;
+    }
+
+    void swap(roaring_set& other)
+    {
+        chunks_.swap(other.chunks_);
+        std::swap(size_, other.size_);
+    }
+
+    void clear() noexcept
+    {
+        chunks_.clear();
+        size_ = 0;
+    }
+
+    roaring_set& operator|=(const roaring_set& other)
+    {
+        if ( this == &other )
+        {
+            return *this;
+        }
+        std::vector<chunk> result;
+        result.reserve(chunks_.size() + other.chunks_.size());
+        std::vector<chunk>::iterator lhs = chunks_.begin();
+        std::vector<chunk>::const_iterator rhs = other.chunks_.begin();
+        while ( lhs != chunks_.end() || rhs != other.chunks_.end() )
+        {
+            if ( rhs == other.chunks_.end() || ( lhs != chunks_.end() && lhs->key < rhs->key ) )
+            {
+                result.push_back(std::move(*lhs++));
+            }
+            else if ( lhs == chunks_.end() || rhs->key < lhs->key )
+            {
+                result.push_back(*rhs++);
+            }
+            else
+            {
+                result.push_back(std::move(*lhs++));
+                unite(result.back(), *rhs++);
+            }
+        }
+        chunks_.swap(result);
+        recount();
+        return *this;
+    }
+
+    roaring_set& operator&=(const roaring_set& other)
+    {
+        if ( this == &other )
+        {
+            return *this;
+        }
+        std::vector<chunk> result;
+        std::vector<chunk>::iterator lhs = chunks_.begin();
+        std::vector<chunk>::const_iterator rhs = other.chunks_.begin();
+        while ( lhs != chunks_.end() && rhs != other.chunks_.end() )
+        {
+            if ( lhs->key < rhs->key )
+            {
+                ++lhs;
+            }
+            else if ( rhs->key < lhs->key )
+            {
+                ++rhs;
+            }
+            else
+            {
+                intersect(*lhs, *rhs++);
+                if ( lhs->cardinality != 0 )
+                {
+                    result.push_back(std::move(*lhs));
+                }
+                ++lhs;
+            }
+        }
+        chunks_.swap(result);
+        recount();
+        return *this;
+    }
+
+    const_iterator find(value_type val) const
+    {
+        const_iterator it = lower_bound(val);
+        return ( it != end() && *it == val ) ? it : end();
+    }
+
+    size_type count(value_type val) const
+    {
+        std::vector<chunk>::const_iterator it = find_chunk(val);
+        return ( it != chunks_.end() && it->key == (val >> 16) &&
+                 chunk_contains(*it, static_cast<std::uint16_t>(val)) ) ? 1 : 0;
+    }
+
+    const_iterator lower_bound(value_type val) const
+    {
+        std::vector<chunk>::const_iterator it = find_chunk(val);
+        size_type position = it - chunks_.begin();
+        if ( it != chunks_.end() && it->key == (val >> 16) )
+        {
+            const_iterator result(this, position, 0, 0);
+            if ( chunk_lower_bound(*it, val & 0xffff, result.index_, result.low_) )
+            {
+                return result;
+            }
+            ++position;
+        }
+        return first_of(position);
+    }
+
+    const_iterator upper_bound(value_type val) const
+    {
+        return ( val == 0xffffffff ) ? end() : lower_bound(val + 1);
+    }
+
+    std::pair<const_iterator, const_iterator> equal_range(value_type val) const
+    {
+        return std::make_pair(lower_bound(val), upper_bound(val));
+    }
+
+    key_compare key_comp() const
+    {
+        return key_compare();
+    }
+
+    value_compare value_comp() const
+    {
+        return value_compare();
+    }
+
+    /**
+     * Bytes held by the set, counting container capacities.
+     */
+    size_type memory_usage() const noexcept
+    {
+        size_type bytes = sizeof(*this) + chunks_.capacity() * sizeof(chunk);
+        for ( std::vector<chunk>::const_iterator it = chunks_.begin(); it != chunks_.end(); ++it )
+        {
+            bytes += it->values.capacity() * sizeof(std::uint16_t) + it->bits.capacity() * sizeof(std::uint64_t);
+        }
+        return bytes;
+    }
+
+private:
+    static const std::uint32_t  array_limit = 4096;
+    static const std::uint32_t  chunk_span = 65536;
+    static const size_type      bitmap_words = chunk_span / 64;
+
+    template <class InputIterator>
+    void build(InputIterator first, InputIterator last)
+    {
+        for ( ; first != last; ++first )
+        {
+            value_type val = *first;
+            std::uint16_t low = static_cast<std::uint16_t>(val);
+            if ( chunks_.empty() || chunks_.back().key != (val >> 16) )
+            {
+                if ( !chunks_.empty() )
+                {
+                    normalize(chunks_.back(), true);
+                }
+                chunks_.push_back(chunk());
+                chunks_.back().key = static_cast<std::uint16_t>(val >> 16);
+                chunks_.back().kind = array_chunk;
+                chunks_.back().cardinality = 0;
+            }
+            chunk& current = chunks_.back();
+            widen(current);
+            if ( current.kind == array_chunk )
+            {
+                current.values.push_back(low);
+            }
+            else
+            {
+                current.bits[low / 64] |= std::uint64_t(1) << (low % 64);
+            }
+            ++current.cardinality;
+            ++size_;
+        }
+        if ( !chunks_.empty() )
+        {
+            normalize(chunks_.back(), true);
+        }
+    }
+
+    std::vector<chunk>::iterator find_chunk(value_type val)
+    {
+        return chunks_.begin() + (static_cast<const roaring_set&>(*this).find_chunk(val) - chunks_.cbegin());
+    }
+
+    std::vector<chunk>::const_iterator find_chunk(value_type val) const
+    {
+        return std::lower_bound(chunks_.begin(), chunks_.end(), val >> 16,
+                                [](const chunk& lhs, value_type high)
+                                {
+                                    return lhs.key < high;
+                                });
+    }
+
+    const_iterator first_of(size_type position) const
+    {
+        const_iterator result(this, position, 0, 0);
+        if ( position != chunks_.size() )
+        {
+            chunk_lower_bound(chunks_[position], 0, result.index_, result.low_);
+        }
+        return result;
+    }
+
+    void advance(const_iterator& it) const
+    {
+        const chunk& current = chunks_[it.chunk_];
+        switch ( current.kind )
+        {
+        case array_chunk:
+            if ( ++it.index_ < current.values.size() )
+            {
+                it.low_ = current.values[it.index_];
+                return;
+            }
+            break;
+        case bitmap_chunk:
+            if ( it.low_ + 1 < chunk_span )
+            {
+                std::uint32_t next = next_bit(current.bits, it.low_ + 1, false);
+                if ( next != chunk_span )
+                {
+                    it.low_ = next;
+                    return;
+                }
+            }
+            break;
+        case run_chunk:
+            if ( it.low_ < current.values[2 * it.index_ + 1] )
+            {
+                ++it.low_;
+                return;
+            }
+            if ( ++it.index_ < current.values.size() / 2 )
+            {
+                it.low_ = current.values[2 * it.index_];
+                return;
+            }
+            break;
+        }
+        it = first_of(it.chunk_ + 1);
+    }
+
+    static std::uint32_t next_bit(const std::vector<std::uint64_t>& bits, std::uint32_t from, bool clear)
+    {
+        const std::uint64_t flip = clear ? ~std::uint64_t(0) : 0;
+        size_type word = from / 64;
+        std::uint64_t current = (bits[word] ^ flip) & (~std::uint64_t(0) << (from % 64));
+        while ( current == 0 )
+        {
+            if ( ++word == bitmap_words )
+            {
+                return chunk_span;
+            }
+            current = bits[word] ^ flip;
+        }
+        return static_cast<std::uint32_t>(word * 64 + detail::count_trailing_zeros64(current));
+    }
+
+    static void set_range(std::vector<std::uint64_t>& bits, std::uint32_t first, std::uint32_t last)
+    {
+        while ( first <= last )
+        {
+            std::uint32_t offset = first % 64, span = std::min<std::uint32_t>(64 - offset, last - first + 1);
+            std::uint64_t mask = ( span == 64 ) ? ~std::uint64_t(0) : ((std::uint64_t(1) << span) - 1) << offset;
+            bits[first / 64] |= mask;
+            first += span;
+        }
+    }
+
+    static std::uint32_t popcount(const std::vector<std::uint64_t>& bits)
+    {
+        std::uint32_t count = 0;
+        for ( size_type i = 0; i < bits.size(); ++i )
+        {
+            count += detail::popcount64(bits[i]);
+        }
+        return count;
+    }
+
+    static size_type count_runs(const chunk& current)
+    {
+        if ( current.kind == run_chunk )
+        {
+            return current.values.size() / 2;
+        }
+        size_type runs = 0;
+        if ( current.kind == array_chunk )
+        {
+            for ( size_type i = 0; i < current.values.size(); ++i )
+            {
+                runs += ( i == 0 || current.values[i] != current.values[i - 1] + 1 ) ? 1 : 0;
+            }
+            return runs;
+        }
+        std::uint64_t carry = 0;
+        for ( size_type i = 0; i < bitmap_words; ++i )
+        {
+            runs += detail::popcount64(current.bits[i] & ~((current.bits[i] << 1) | carry));
+            carry = current.bits[i] >> 63;
+        }
+        return runs;
+    }
+
+    static bool chunk_contains(const chunk& current, std::uint16_t low)
+    {
+        switch ( current.kind )
+        {
+        case array_chunk:
+            return std::binary_search(current.values.begin(), current.values.end(), low);
+        case bitmap_chunk:
+            return ((current.bits[low / 64] >> (low % 64)) & 1) != 0;
+        case run_chunk:
+            {
+                size_type index = 0;
+                std::uint32_t value = 0;
+                return chunk_lower_bound(current, low, index, value) && value == low;
+            }
+        }
+        return false;
+    }
+
+    static bool chunk_lower_bound(const chunk& current, std::uint32_t low, size_type& index, std::uint32_t& value)
+    {
+        switch ( current.kind )
+        {
+        case array_chunk:
+            {
+                std::vector<std::uint16_t>::const_iterator it =
+                    std::lower_bound(current.values.begin(), current.values.end(), low);
+                if ( it == current.values.end() )
+                {
+                    return false;
+                }
+                index = it - current.values.begin();
+                value = *it;
+                return true;
+            }
+        case bitmap_chunk:
+            value = next_bit(current.bits, low, false);
+            return value != chunk_span;
+        case run_chunk:
+            {
+                size_type first = 0, last = current.values.size() / 2;
+                while ( first < last )
+                {
+                    size_type middle = first + (last - first) / 2;
+                    if ( current.values[2 * middle + 1] < low )
+                    {
+                        first = middle + 1;
+                    }
+                    else
+                    {
+                        last = middle;
+                    }
+                }
+                if ( first == current.values.size() / 2 )
+                {
+                    return false;
+                }
+                index = first;
+                value = std::max<std::uint32_t>(current.values[2 * first], low);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Run chunks and full arrays become bitmaps before a key is added.
+     */
+    static void widen(chunk& current)
+    {
+        if ( current.kind == run_chunk || current.cardinality >= array_limit )
+        {
+            force_bitmap(current);
+        }
+    }
+
+    static void force_bitmap(chunk& current)
+    {
+        if ( current.kind == bitmap_chunk )
+        {
+            return;
+        }
+        std::vector<std::uint64_t> bits(bitmap_words, 0);
+        if ( current.kind == array_chunk )
+        {
+            for ( size_type i = 0; i < current.values.size(); ++i )
+            {
+                bits[current.values[i] / 64] |= std::uint64_t(1) << (current.values[i] % 64);
+            }
+        }
+        else
+        {
+            for ( size_type i = 0; i < current.values.size(); i += 2 )
+            {
+                set_range(bits, current.values[i], current.values[i + 1]);
+            }
+        }
+        std::vector<std::uint16_t>().swap(current.values);
+        current.bits.swap(bits);
+        current.kind = bitmap_chunk;
+    }
+
+    static void normalize(chunk& current, bool with_runs)
+    {
+        size_type runs = ( with_runs || current.kind == run_chunk ) ? count_runs(current) : chunk_span;
+        size_type array_bytes = ( current.cardinality <= array_limit ) ? 2 * current.cardinality : chunk_span;
+        size_type bitmap_bytes = bitmap_words * sizeof(std::uint64_t);
+        chunk_kind target = ( 4 * runs < std::min(array_bytes, bitmap_bytes) ) ? run_chunk
+                          : ( current.cardinality <= array_limit ) ? array_chunk
+                          : bitmap_chunk;
+        if ( target == current.kind )
+        {
+            return;
+        }
+        force_bitmap(current);
+        if ( target == bitmap_chunk )
+        {
+            return;
+        }
+        std::vector<std::uint16_t> values;
+        if ( target == array_chunk )
+        {
+            values.reserve(current.cardinality);
+            for ( size_type word = 0; word < bitmap_words; ++word )
+            {
+                for ( std::uint64_t bits = current.bits[word]; bits != 0; bits &= bits - 1 )
+                {
+                    values.push_back(static_cast<std::uint16_t>(word * 64 + detail::count_trailing_zeros64(bits)));
+                }
+            }
+        }
+        else
+        {
+            values.reserve(2 * runs);
+            for ( std::uint32_t first = next_bit(current.bits, 0, false); first != chunk_span; )
+            {
+                std::uint32_t last = next_bit(current.bits, first, true);
+                values.push_back(static_cast<std::uint16_t>(first));
+                values.push_back(static_cast<std::uint16_t>(last - 1));
+                first = ( last == chunk_span ) ? chunk_span : next_bit(current.bits, last, false);
+            }
+        }
+        std::vector<std::uint64_t>().swap(current.bits);
+        current.values.swap(values);
+        current.kind = target;
+    }
+
+    static void unite(chunk& current, const chunk& other)
+    {
+        if ( current.kind == array_chunk && other.kind == array_chunk )
+        {
+            std::vector<std::uint16_t> values;
+            values.reserve(current.values.size() + other.values.size());
+            std::set_union(current.values.begin(), current.values.end(),
+                           other.values.begin(), other.values.end(), std::back_inserter(values));
+            current.values.swap(values);
+            current.cardinality = static_cast<std::uint32_t>(current.values.size());
+        }
+        else
+        {
+            force_bitmap(current);
+            if ( other.kind == bitmap_chunk )
+            {
+                for ( size_type i = 0; i < bitmap_words; ++i )
+                {
+                    current.bits[i] |= other.bits[i];
+                }
+            }
+            else if ( other.kind == array_chunk )
+            {
+                for ( size_type i = 0; i < other.values.size(); ++i )
+                {
+                    current.bits[other.values[i] / 64] |= std::uint64_t(1) << (other.values[i] % 64);
+                }
+            }
+            else
+            {
+                for ( size_type i = 0; i < other.values.size(); i += 2 )
+                {
+                    set_range(current.bits, other.values[i], other.values[i + 1]);
+                }
+            }
+            current.cardinality = popcount(current.bits);
+        }
+        normalize(current, true);
+    }
+
+    static void intersect(chunk& current, const chunk& other)
+    {
+        if ( current.kind == array_chunk || other.kind == array_chunk )
+        {
+            const chunk& probe = ( current.kind == array_chunk ) ? other : current;
+            const std::vector<std::uint16_t>& source = ( current.kind == array_chunk ) ? current.values : other.values;
+            std::vector<std::uint16_t> values;
+            for ( size_type i = 0; i < source.size(); ++i )
+            {
+                if ( chunk_contains(probe, source[i]) )
+                {
+                    values.push_back(source[i]);
+                }
+            }
+            std::vector<std::uint64_t>().swap(current.bits);
+            current.values.swap(values);
+            current.kind = array_chunk;
+            current.cardinality = static_cast<std::uint32_t>(current.values.size());
+        }
+        else
+        {
+            force_bitmap(current);
+            chunk mask(other);
+            force_bitmap(mask);
+            for ( size_type i = 0; i < bitmap_words; ++i )
+            {
+                current.bits[i] &= mask.bits[i];
+            }
+            current.cardinality = popcount(current.bits);
+        }
+        if ( current.cardinality != 0 )
+        {
+            normalize(current, true);
+        }
+    }
+
+    void recount()
+    {
+        size_ = 0;
+        for ( std::vector<chunk>::const_iterator it = chunks_.begin(); it != chunks_.end(); ++it )
+        {
+            size_ += it->cardinality;
+        }
+    }
+
+    std::vector<chunk>  chunks_;
+    size_type           size_;
+};  // class roaring_set
+
+inline roaring_set operator|(const roaring_set& lhs, const roaring_set& rhs)
+{
+    roaring_set result(lhs);
+    result |= rhs;
+    return result;
+}
+
+inline roaring_set operator&(const roaring_set& lhs, const roaring_set& rhs)
+{
+    roaring_set result(lhs);
+    result &= rhs;
+    return result;
+}
+
+}  // namespace eos
+
+#endif  // EOS_ROARING_SET_H_
@@ -0,0 +1,430 @@
+/**
+ * @author Gracjan Olbinski <gracjan.olbinski@gmail.com>
+ */
+
+
+#ifndef EOS_SHARDED_LINEAR_SET_H_
+#define EOS_SHARDED_LINEAR_SET_H_
+
+#include <cstddef>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "eos/linear_set.h"
+#include "eos/detail/platform.h"
+
+namespace eos
+{
+
+/**
+ * linear_set range-partitioned over Shards independently locked shards, so
+ * writers touching different key ranges do not contend. Shard k holds the
+ * keys in [splitters[k - 1], splitters[k]); the splitter vector is published
+ * through an atomic pointer and writers re-check it after locking their
+ * shard. rebalance() recomputes splitters from the key distribution under
+ * all shard locks; inserts trigger it when one shard outgrows the others.
+ * Routing reads the splitters without a lock, so every router is counted
+ * while it holds a splitter pointer; superseded splitter vectors are freed
+ * as soon as that count drops to zero.
+ */
+template <
+    typename T,
+    std::size_t Shards = 16,
+    typename Compare = std::less<T>,
+    typename Alloc = std::allocator<T>
+    >
+class sharded_linear_set
+{
+    static_assert(Shards > 0, "sharded_linear_set needs at least one shard");
+
+    typedef          std::vector<T>                         splitter_type;
+public:
+    typedef          linear_set<T, Compare, Alloc>          set_type;
+    typedef          T                                      key_type;
+    typedef          T                                      value_type;
+    typedef          Compare                                key_compare;
+    typedef          Alloc                                  allocator_type;
+    typedef          std::size_t                            size_type;
+
+    explicit sharded_linear_set(const key_compare& comp = key_compare(),
+                                const allocator_type& alloc = allocator_type())
+    : comp_(comp)
+    , alloc_(alloc)
+    , splitters_(nullptr)
+    , routers_(0)
+    , retired_count_(0)
+    {
+        init(splitter_type());
+    }
+
+    /**
+     * Starts from caller-provided sorted splitters, at most Shards - 1 of them.
+     */
+    explicit sharded_linear_set(splitter_type splitters,
+                                const key_compare& comp = key_compare(),
+                                const allocator_type& alloc = allocator_type())
+    : comp_(comp)
+    , alloc_(alloc)
+    , splitters_(nullptr)
+    , routers_(0)
+    , retired_count_(0)
+    {
+        init(std::move(splitters));
+    }
+
+    sharded_linear_set(const sharded_linear_set&) = delete;
+    sharded_linear_set& operator=(const sharded_linear_set&) = delete;
+
+    static constexpr size_type shard_count()
+    {
+        return Shards;
+    }
+
+    size_type size() const
+    {
+        size_type total = 0;
+        for ( size_type i = 0; i < Shards; ++i )
+        {
+            total += shards_[i].count.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    /**
+     * Superseded splitter vectors still waiting for routers to let go of them.
+     */
+    size_type retired() const
+    {
+        return retired_count_.load();
+    }
+
+    size_type shard_size(size_type shard) const
+    {
+        return shards_[shard].count.load(std::memory_order_relaxed);
+    }
+
+    bool insert(const value_type& val)
+    {
+        size_type index = 0, before = 0;
+        bool inserted = false;
+        {
+            std::unique_lock<std::mutex> lock = lock_route(val, index);
+            shard& target = shards_[index];
+            before = target.set.size();
+            inserted = target.set.insert(val).second;
+            target.count.store(target.set.size(), std::memory_order_relaxed);
+        }
+        if ( inserted )
+        {
+            maybe_rebalance(index, before);
+        }
+        return inserted;
+    }
+
+    /**
+     * Sorts the batch once and hands each shard its contiguous slice in a
+     * single locked batch insert.
+     */
+    template <class InputIterator>
+    void insert(InputIterator first, InputIterator last)
+    {
+        std::vector<value_type> batch(first, last);
+        std::sort(batch.begin(), batch.end(), comp_);
+        size_type before[Shards];
+        for ( size_type i = 0; i < Shards; ++i )
+        {
+            before[i] = shard_size(i);
+        }
+        typename std::vector<value_type>::iterator position = batch.begin();
+        while ( position != batch.end() )
+        {
+            route_guard guard(*this);
+            const splitter_type* splitters = splitters_.load();
+            size_type index = route(*splitters, *position);
+            typename std::vector<value_type>::iterator next = ( index < splitters->size() )
+                ? std::lower_bound(position, batch.end(), (*splitters)[index], comp_)
+                : batch.end();
+            std::unique_lock<std::mutex> lock(shards_[index].mutex);
+            if ( splitters_.load() != splitters )
+            {
+                continue;
+            }
+            shards_[index].set.insert(position, next);
+            shards_[index].count.store(shards_[index].set.size(), std::memory_order_relaxed);
+            position = next;
+        }
+        for ( size_type i = 0; i < Shards; ++i )
+        {
+            maybe_rebalance(i, before[i]);
+        }
+    }
+
+    size_type erase(const value_type& val)
+    {
+        size_type index = 0;
+        std::unique_lock<std::mutex> lock = lock_route(val, index);
+        shard& target = shards_[index];
+        size_type erased = target.set.erase(val);
+        target.count.store(target.set.size(), std::memory_order_relaxed);
+        return erased;
+    }
+
+    size_type count(const value_type& val) const
+    {
+        size_type index = 0;
+        std::unique_lock<std::mutex> lock = lock_route(val, index);
+        return shards_[index].set.count(val);
+    }
+
+    void clear()
+    {
+        std::vector<std::unique_lock<std::mutex> > locks = lock_all();
+        for ( size_type i = 0; i < Shards; ++i )
+        {
+            shards_[i].set.clear();
+            shards_[i].count.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Calls f on every key in order while holding all shard locks; shards
+     * are disjoint ranges, so visiting them in turn is a global merge.
+     */
+    template <class Function>
+    void for_each(Function f) const
+    {
+        std::vector<std::unique_lock<std::mutex> > locks = lock_all();
+        for ( size_type i = 0; i < Shards; ++i )
+        {
+            for ( typename set_type::const_iterator it = shards_[i].set.begin(); it != shards_[i].set.end(); ++it )
+            {
+                f(*it);
+            }
+        }
+    }
+
+    set_type snapshot() const
+    {
+        std::vector<value_type> keys;
+        {
+            std::vector<std::unique_lock<std::mutex> > locks = lock_all();
+            size_type total = 0;
+            for ( size_type i = 0; i < Shards; ++i )
+            {
+                total += shards_[i].set.size();
+            }
+            keys.reserve(total);
+            for ( size_type i = 0; i < Shards; ++i )
+            {
+                keys.insert(keys.end(), shards_[i].set.begin(), shards_[i].set.end());
+            }
+        }
+        return set_type(std::make_move_iterator(keys.begin()), std::make_move_iterator(keys.end()),
+                        comp_, alloc_);
+    }
+
+    /**
+     * Moves keys between shards so that each holds an equal share, and
+     * publishes the matching splitters.
+     */
+    void rebalance()
+    {
+        std::vector<std::unique_lock<std::mutex> > locks = lock_all();
+        std::vector<value_type> keys;
+        for ( size_type i = 0; i < Shards; ++i )
+        {
+            keys.insert(keys.end(),
+                        std::make_move_iterator(shards_[i].set.begin()),
+                        std::make_move_iterator(shards_[i].set.end()));
+        }
+        if ( keys.empty() )
+        {
+            return;
+        }
+        std::unique_ptr<splitter_type> splitters(new splitter_type());
+        splitters->reserve(Shards - 1);
+        for ( size_type i = 1; i < Shards; ++i )
+        {
+            splitters->push_back(keys[keys.size() * i / Shards]);
+        }
+        for ( size_type i = 0; i < Shards; ++i )
+        {
+            set_type slice(std::make_move_iterator(keys.begin() + keys.size() * i / Shards),
+                           std::make_move_iterator(keys.begin() + keys.size() * (i + 1) / Shards),
+                           comp_, alloc_);
+            shards_[i].set.swap(slice);
+            shards_[i].count.store(shards_[i].set.size(), std::memory_order_relaxed);
+        }
+        publish(splitters.release());
+    }
+
+    key_compare key_comp() const
+    {
+        return comp_;
+    }
+
+    allocator_type get_allocator() const
+    {
+        return alloc_;
+    }
+
+private:
+    static const size_type rebalance_minimum = 4096;
+    static const size_type rebalance_period = 256;
+
+    /**
+     * One cache line or more per shard, so that a writer locking one shard
+     * does not invalidate the mutex and count of its neighbours. Before
+     * C++17 a heap-allocated sharded_linear_set only gets this alignment
+     * from an allocator that honours alignof.
+     */
+    struct alignas(detail::cache_line_size) shard
+    {
+        shard()
+        : count(0)
+        {
+        }
+
+        mutable std::mutex          mutex;
+        set_type                    set;
+        std::atomic<size_type>      count;
+    };
+
+    /**
+     * Counts the caller as a router for as long as it may dereference or
+     * compare a splitter pointer loaded without the shard locks.
+     */
+    class route_guard
+    {
+    public:
+        explicit route_guard(const sharded_linear_set& owner)
+        : owner_(owner)
+        {
+            owner_.routers_.fetch_add(1);
+        }
+
+        route_guard(const route_guard&) = delete;
+        route_guard& operator=(const route_guard&) = delete;
+
+        ~route_guard()
+        {
+            if ( owner_.routers_.fetch_sub(1) == 1 && owner_.retired_count_.load() != 0 )
+            {
+                std::lock_guard<std::mutex> lock(owner_.versions_mutex_);
+                owner_.reclaim_locked();
+            }
+        }
+
+    private:
+        const sharded_linear_set& owner_;
+    };  // class route_guard
+
+    void init(splitter_type splitters)
+    {
+        for ( size_type i = 0; i < Shards; ++i )
+        {
+            set_type(comp_, alloc_).swap(shards_[i].set);
+        }
+        publish(new splitter_type(std::move(splitters)));
+    }
+
+    void publish(const splitter_type* splitters)
+    {
+        std::lock_guard<std::mutex> lock(versions_mutex_);
+        if ( current_ )
+        {
+            retired_.push_back(std::move(current_));
+        }
+        current_.reset(splitters);
+        splitters_.store(splitters);
+        retired_count_.store(retired_.size());
+        reclaim_locked();
+    }
+
+    /**
+     * A router that loaded a retired pointer registered before loading it,
+     * and the pointer was retired before this check, so a zero count means
+     * nobody can still reach the retired vectors.
+     */
+    void reclaim_locked() const
+    {
+        if ( !retired_.empty() && routers_.load() == 0 )
+        {
+            retired_.clear();
+            retired_count_.store(0);
+        }
+    }
+
+    size_type route(const splitter_type& splitters, const value_type& val) const
+    {
+        return std::upper_bound(splitters.begin(), splitters.end(), val, comp_) - splitters.begin();
+    }
+
+    std::unique_lock<std::mutex> lock_route(const value_type& val, size_type& index) const
+    {
+        for ( ;; )
+        {
+            route_guard guard(*this);
+            const splitter_type* splitters = splitters_.load();
+            index = route(*splitters, val);
+            std::unique_lock<std::mutex> lock(shards_[index].mutex);
+            if ( splitters_.load() == splitters )
+            {
+                return lock;
+            }
+        }
+    }
+
+    std::vector<std::unique_lock<std::mutex> > lock_all() const
+    {
+        std::vector<std::unique_lock<std::mutex> > locks;
+        locks.reserve(Shards);
+        for ( size_type i = 0; i < Shards; ++i )
+        {
+            locks.push_back(std::unique_lock<std::mutex>(shards_[i].mutex));
+        }
+        return locks;
+    }
+
+    /**
+     * Checks the balance whenever a shard crosses a multiple of
+     * rebalance_period, however many keys the crossing insert added.
+     */
+    void maybe_rebalance(size_type index, size_type before)
+    {
+        size_type count = shards_[index].count.load(std::memory_order_relaxed);
+        if ( Shards == 1 || count < rebalance_minimum || before / rebalance_period == count / rebalance_period )
+        {
+            return;
+        }
+        if ( count > 2 * size() / Shards )
+        {
+            rebalance();
+        }
+    }
+
+    key_compare                                             comp_;
+    allocator_type                                          alloc_;
+    shard                                                   shards_[Shards];
+    std::atomic<const splitter_type*>                       splitters_;
+    mutable std::atomic<size_type>                          routers_;
+    mutable std::atomic<size_type>                          retired_count_;
+    mutable std::mutex                                      versions_mutex_;
+    std::unique_ptr<const splitter_type>                    current_;
+    mutable std::vector<std::unique_ptr<const splitter_type> >  retired_;
+};  // class sharded_linear_set
+
+}  // namespace eos
+
+#endif  // EOS_SHARDED_LINEAR_SET_H_
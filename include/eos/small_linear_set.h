@@ -0,0 +1,29 @@
+/**
+ * @author Gracjan Olbinski <gracjan.olbinski@gmail.com>
+ */
+
+
+#ifndef EOS_SMALL_LINEAR_SET_H_
+#define EOS_SMALL_LINEAR_SET_H_
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+#include "eos/linear_set.h"
+#include "eos/small_vector.h"
+
+namespace eos
+{
+
+template <
+    typename Key,
+    std::size_t N,
+    typename Compare = std::less<Key>,
+    typename Alloc = std::allocator<Key>
+    >
+using small_linear_set = linear_set<Key, Compare, Alloc, default_growth, small_vector<Key, N, Alloc> >;
+
+}  // namespace eos
+
+#endif  // EOS_SMALL_LINEAR_SET_H_
@@ -0,0 +1,549 @@
+/**
+ * @author Gracjan Olbinski <gracjan.olbinski@gmail.com>
+ */
+
+
+#ifndef EOS_SMALL_VECTOR_H_
+#define EOS_SMALL_VECTOR_H_
+
+#include <cstddef>
+#include <memory>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <initializer_list>
+#include <utility>
+
+namespace eos
+{
+
+/**
+ * Vector keeping up to N elements inside the object and moving them to
+ * memory obtained from Alloc only once it grows past N.
+ */
+template <
+    typename T,
+    std::size_t N,
+    typename Alloc = std::allocator<T>
+    >
+class small_vector
+{
+    static_assert(N > 0, "small_vector needs room for at least one inline element");
+
+    typedef          std::allocator_traits<Alloc>           alloc_traits;
+public:
+    typedef          T                                      value_type;
+    typedef          Alloc                                  allocator_type;
+    typedef          value_type&                            reference;
+    typedef          const value_type&                      const_reference;
+    typedef          value_type*                            pointer;
+    typedef          const value_type*                      const_pointer;
+    typedef          value_type*                            iterator;
+    typedef          const value_type*                      const_iterator;
+    typedef          std::reverse_iterator<iterator>        reverse_iterator;
+    typedef          std::reverse_iterator<const_iterator>  const_reverse_iterator;
+    typedef          std::ptrdiff_t                         difference_type;
+    typedef          std::size_t                            size_type;
+
+    explicit small_vector(const allocator_type& alloc = allocator_type())
+    : alloc_(alloc)
+    , begin_(inline_data())
+    , end_(inline_data())
+    , capacity_end_(inline_data() + N)
+    {
+    }
+
+    template <class InputIterator>
+    small_vector(InputIterator first, InputIterator last,
+                 const allocator_type& alloc = allocator_type())
+    : alloc_(alloc)
+    , begin_(inline_data())
+    , end_(inline_data())
+    , capacity_end_(inline_data() + N)
+    {
+        insert(end(), first, last);
+    }
+
+    small_vector(std::initializer_list<value_type> il,
+                 const allocator_type& alloc = allocator_type())
+    : alloc_(alloc)
+    , begin_(inline_data())
+    , end_(inline_data())
+    , capacity_end_(inline_data() + N)
+    {
+        insert(end(), il.begin(), il.end());
+    }
+
+    small_vector(const small_vector& other)
+    : alloc_(alloc_traits::select_on_container_copy_construction(other.alloc_))
+    , begin_(inline_data())
+    , end_(inline_data())
+    , capacity_end_(inline_data() + N)
+    {
+        insert(end(), other.begin(), other.end());
+    }
+
+    small_vector(const small_vector& other, const allocator_type& alloc)
+    : alloc_(alloc)
+    , begin_(inline_data())
+    , end_(inline_data())
+    , capacity_end_(inline_data() + N)
+    {
+        insert(end(), other.begin(), other.end());
+    }
+
+    /**
+     * Takes over other's heap buffer or, when other is inline, moves its at
+     * most N elements into the inline buffer; neither allocates.
+     */
+    small_vector(small_vector&& other) noexcept(std::is_nothrow_move_constructible<T>::value)
+    : alloc_(other.alloc_)
+    , begin_(inline_data())
+    , end_(inline_data())
+    , capacity_end_(inline_data() + N)
+    {
+        steal(other);
+    }
+
+    small_vector(small_vector&& other, const allocator_type& alloc)
+    : alloc_(alloc)
+    , begin_(inline_data())
+    , end_(inline_data())
+    , capacity_end_(inline_data() + N)
+    {
+        steal(other);
+    }
+
+    ~small_vector()
+    {
+        clear();
+        release();
+    }
+
+    small_vector& operator=(const small_vector& other)
+    {
+        if ( this != &other )
+        {
+            if ( alloc_traits::propagate_on_container_copy_assignment::value && alloc_ != other.alloc_ )
+            {
+                clear();
+                release();
+                alloc_ = other.alloc_;
+            }
+            assign(other.begin(), other.end());
+        }
+        return *this;
+    }
+
+    small_vector& operator=(small_vector&& other)
+    {
+        if ( this != &other )
+        {
+            clear();
+            if ( alloc_traits::propagate_on_container_move_assignment::value )
+            {
+                release();
+                alloc_ = other.alloc_;
+            }
+            steal(other);
+        }
+        return *this;
+    }
+
+    small_vector& operator=(std::initializer_list<value_type> il)
+    {
+        assign(il.begin(), il.end());
+        return *this;
+    }
+
+    template <class InputIterator>
+    void assign(InputIterator first, InputIterator last)
+    {
+        clear();
+        insert(end(), first, last);
+    }
+
+    iterator begin() noexcept
+    {
+        return begin_;
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return begin_;
+    }
+
+    const_iterator cbegin() const noexcept
+    {
+        return begin_;
+    }
+
+    iterator end() noexcept
+    {
+        return end_;
+    }
+
+    const_iterator end() const noexcept
+    {
+        return end_;
+    }
+
+    const_iterator cend() const noexcept
+    {
+        return end_;
+    }
+
+    reverse_iterator rbegin() noexcept
+    {
+        return reverse_iterator(end());
+    }
+
+    const_reverse_iterator rbegin() const noexcept
+    {
+        return const_reverse_iterator(end());
+    }
+
+    const_reverse_iterator crbegin() const noexcept
+    {
+        return const_reverse_iterator(end());
+    }
+
+    reverse_iterator rend() noexcept
+    {
+        return reverse_iterator(begin());
+    }
+
+    const_reverse_iterator rend() const noexcept
+    {
+        return const_reverse_iterator(begin());
+    }
+
+    const_reverse_iterator crend() const noexcept
+    {
+        return const_reverse_iterator(begin());
+    }
+
+    bool empty() const noexcept
+    {
+        return begin_ == end_;
+    }
+
+    size_type size() const noexcept
+    {
+        return end_ - begin_;
+    }
+
+    size_type max_size() const noexcept
+    {
+        return alloc_traits::max_size(alloc_);
+    }
+
+    size_type capacity() const noexcept
+    {
+        return capacity_end_ - begin_;
+    }
+
+    bool is_inline() const noexcept
+    {
+        return begin_ == inline_data();
+    }
+
+    void reserve(size_type n)
+    {
+        if ( n > capacity() )
+        {
+            relocate(n);
+        }
+    }
+
+    void shrink_to_fit()
+    {
+        if ( !is_inline() && size() < capacity() )
+        {
+            relocate(size());
+        }
+    }
+
+    reference operator[](size_type n)
+    {
+        return begin_[n];
+    }
+
+    const_reference operator[](size_type n) const
+    {
+        return begin_[n];
+    }
+
+    reference at(size_type n)
+    {
+        if ( n >= size() )
+        {
+            throw std::out_of_range("small_vector::at");
+        }
+        return begin_[n];
+    }
+
+    const_reference at(size_type n) const
+    {
+        if ( n >= size() )
+        {
+            throw std::out_of_range("small_vector::at");
+        }
+        return begin_[n];
+    }
+
+    reference front()
+    {
+        return *begin_;
+    }
+
+    const_reference front() const
+    {
+        return *begin_;
+    }
+
+    reference back()
+    {
+        return *(end_ - 1);
+    }
+
+    const_reference back() const
+    {
+        return *(end_ - 1);
+    }
+
+    value_type* data() noexcept
+    {
+        return begin_;
+    }
+
+    const value_type* data() const noexcept
+    {
+        return begin_;
+    }
+
+    void push_back(const value_type& val)
+    {
+        emplace(end(), val);
+    }
+
+    void push_back(value_type&& val)
+    {
+        emplace(end(), std::move(val));
+    }
+
+    template <class... Args>
+    void emplace_back(Args&&... args)
+    {
+        emplace(end(), std::forward<Args>(args)...);
+    }
+
+    void pop_back()
+    {
+        alloc_traits::destroy(alloc_, --end_);
+    }
+
+    iterator insert(const_iterator position, const value_type& val)
+    {
+        return emplace(position, val);
+    }
+
+    iterator insert(const_iterator position, value_type&& val)
+    {
+        return emplace(position, std::move(val));
+    }
+
+    template <class InputIterator>
+    iterator insert(const_iterator position, InputIterator first, InputIterator last)
+    {
+        size_type offset = position - begin_, count = size();
+        append(first, last, typename std::iterator_traits<InputIterator>::iterator_category());
+        std::rotate(begin_ + offset, begin_ + count, end_);
+        return begin_ + offset;
+    }
+
+    template <class... Args>
+    iterator emplace(const_iterator position, Args&&... args)
+    {
+        size_type offset = position - begin_;
+        value_type val(std::forward<Args>(args)...);
+        if ( end_ == capacity_end_ )
+        {
+            relocate(std::max<size_type>(2 * capacity(), size() + 1));
+        }
+        iterator it = begin_ + offset;
+        if ( it == end_ )
+        {
+            alloc_traits::construct(alloc_, end_, std::move(val));
+        }
+        else
+        {
+            alloc_traits::construct(alloc_, end_, std::move(*(end_ - 1)));
+            std::move_backward(it, end_ - 1, end_);
+            *it = std::move(val);
+        }
+        ++end_;
+        return it;
+    }
+
+    iterator erase(const_iterator position)
+    {
+        return erase(position, position + 1);
+    }
+
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        iterator it = begin_ + (first - begin_);
+        iterator tail = std::move(begin_ + (last - begin_), end_, it);
+        destroy(tail, end_);
+        end_ = tail;
+        return it;
+    }
+
+    void clear() noexcept
+    {
+        destroy(begin_, end_);
+        end_ = begin_;
+    }
+
+    void swap(small_vector& other)
+    {
+        if ( !is_inline() && !other.is_inline() )
+        {
+            if ( alloc_traits::propagate_on_container_swap::value )
+            {
+                std::swap(alloc_, other.alloc_);
+            }
+            std::swap(begin_, other.begin_);
+            std::swap(end_, other.end_);
+            std::swap(capacity_end_, other.capacity_end_);
+        }
+        else
+        {
+            small_vector tmp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(tmp);
+        }
+    }
+
+    allocator_type get_allocator() const
+    {
+        return alloc_;
+    }
+
+private:
+    value_type* inline_data() noexcept
+    {
+        return reinterpret_cast<value_type*>(&buffer_);
+    }
+
+    const value_type* inline_data() const noexcept
+    {
+        return reinterpret_cast<const value_type*>(&buffer_);
+    }
+
+    template <class InputIterator>
+    void append(InputIterator first, InputIterator last, std::input_iterator_tag)
+    {
+        for ( ; first != last; ++first )
+        {
+            emplace_back(*first);
+        }
+    }
+
+    template <class ForwardIterator>
+    void append(ForwardIterator first, ForwardIterator last, std::forward_iterator_tag)
+    {
+        size_type count = std::distance(first, last);
+        if ( size() + count > capacity() )
+        {
+            relocate(std::max<size_type>(2 * capacity(), size() + count));
+        }
+        for ( ; first != last; ++first, ++end_ )
+        {
+            alloc_traits::construct(alloc_, end_, *first);
+        }
+    }
+
+    void relocate(size_type n)
+    {
+        value_type* first = ( n <= N ) ? inline_data() : alloc_traits::allocate(alloc_, n);
+        if ( first == begin_ )
+        {
+            return;
+        }
+        value_type* last = first;
+        try
+        {
+            for ( value_type* it = begin_; it != end_; ++it, ++last )
+            {
+                alloc_traits::construct(alloc_, last, std::move_if_noexcept(*it));
+            }
+        }
+        catch ( ... )
+        {
+            destroy(first, last);
+            if ( n > N )
+            {
+                alloc_traits::deallocate(alloc_, first, n);
+            }
+            throw;
+        }
+        clear();
+        release();
+        begin_ = first;
+        end_ = last;
+        capacity_end_ = first + std::max(n, N);
+    }
+
+    void steal(small_vector& other)
+    {
+        if ( !other.is_inline() && alloc_ == other.alloc_ )
+        {
+            release();
+            begin_ = other.begin_;
+            end_ = other.end_;
+            capacity_end_ = other.capacity_end_;
+            other.begin_ = other.end_ = other.inline_data();
+            other.capacity_end_ = other.inline_data() + N;
+        }
+        else
+        {
+            reserve(other.size());
+            for ( value_type* it = other.begin_; it != other.end_; ++it, ++end_ )
+            {
+                alloc_traits::construct(alloc_, end_, std::move(*it));
+            }
+            other.clear();
+        }
+    }
+
+    void destroy(value_type* first, value_type* last) noexcept
+    {
+        for ( ; first != last; ++first )
+        {
+            alloc_traits::destroy(alloc_, first);
+        }
+    }
+
+    void release() noexcept
+    {
+        if ( !is_inline() )
+        {
+            alloc_traits::deallocate(alloc_, begin_, capacity());
+            begin_ = end_ = inline_data();
+            capacity_end_ = inline_data() + N;
+        }
+    }
+
+    allocator_type                                                  alloc_;
+    value_type*                                                     begin_;
+    value_type*                                                     end_;
+    value_type*                                                     capacity_end_;
+    typename std::aligned_storage<sizeof(T) * N, alignof(T)>::type  buffer_;
+};  // class small_vector
+
+}  // namespace eos
+
+#endif  // EOS_SMALL_VECTOR_H_
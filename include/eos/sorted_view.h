@@ -0,0 +1,205 @@
+/**
+ * @author Gracjan Olbinski <gracjan.olbinski@gmail.com>
+ */
+
+
+#ifndef EOS_SORTED_VIEW_H_
+#define EOS_SORTED_VIEW_H_
+
+#include <cstddef>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <utility>
+
+#include "eos/detail/simd_search.h"
+
+namespace eos
+{
+
+/**
+ * Non-owning view over contiguous memory that is already sorted by Compare
+ * and free of equivalent elements. It offers the read-only lookup API of
+ * linear_set without copying; the viewed memory must outlive the view.
+ */
+template <
+    typename T,
+    typename Compare = std::less<T>
+    >
+class sorted_view
+{
+public:
+    typedef          T                                      key_type;
+    typedef          T                                      value_type;
+    typedef          Compare                                key_compare;
+    typedef          Compare                                value_compare;
+    typedef          const value_type&                      reference;
+    typedef          const value_type&                      const_reference;
+    typedef          const value_type*                      pointer;
+    typedef          const value_type*                      const_pointer;
+    typedef          const value_type*                      iterator;
+    typedef          const value_type*                      const_iterator;
+    typedef          std::reverse_iterator<const_iterator>  reverse_iterator;
+    typedef          std::reverse_iterator<const_iterator>  const_reverse_iterator;
+    typedef          std::ptrdiff_t                         difference_type;
+    typedef          std::size_t                            size_type;
+
+    explicit sorted_view(const key_compare& comp = key_compare()) noexcept
+    : comp_(comp)
+    , data_(nullptr)
+    , size_(0)
+    {
+    }
+
+    sorted_view(const value_type* data, size_type size,
+                const key_compare& comp = key_compare()) noexcept
+    : comp_(comp)
+    , data_(data)
+    , size_(size)
+    {
+    }
+
+    sorted_view(const value_type* first, const value_type* last,
+                const key_compare& comp = key_compare()) noexcept
+    : comp_(comp)
+    , data_(first)
+    , size_(last - first)
+    {
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return data_;
+    }
+
+    const_iterator cbegin() const noexcept
+    {
+        return data_;
+    }
+
+    const_iterator end() const noexcept
+    {
+        return data_ + size_;
+    }
+
+    const_iterator cend() const noexcept
+    {
+        return data_ + size_;
+    }
+
+    const_reverse_iterator rbegin() const noexcept
+    {
+        return const_reverse_iterator(end());
+    }
+
+    const_reverse_iterator crbegin() const noexcept
+    {
+        return rbegin();
+    }
+
+    const_reverse_iterator rend() const noexcept
+    {
+        return const_reverse_iterator(begin());
+    }
+
+    const_reverse_iterator crend() const noexcept
+    {
+        return rend();
+    }
+
+    bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    size_type size() const noexcept
+    {
+        return size_;
+    }
+
+    const value_type* data() const noexcept
+    {
+        return data_;
+    }
+
+    const_reference operator[](size_type n) const
+    {
+        return data_[n];
+    }
+
+    const_iterator find(const value_type& val) const
+    {
+        const_iterator it = lower_bound(val);
+        return ( it != end() && !comp_(val, *it) ) ? it : end();
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    const_iterator find(const K& key) const
+    {
+        const_iterator it = lower_bound(key);
+        return ( it != end() && !comp_(key, *it) ) ? it : end();
+    }
+
+    size_type count(const value_type& val) const
+    {
+        return ( find(val) != end() ) ? 1 : 0;
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    size_type count(const K& key) const
+    {
+        return std::distance(lower_bound(key), upper_bound(key));
+    }
+
+    const_iterator lower_bound(const value_type& val) const
+    {
+        return detail::fast_lower_bound(begin(), end(), val, comp_);
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    const_iterator lower_bound(const K& key) const
+    {
+        return std::lower_bound(begin(), end(), key, comp_);
+    }
+
+    const_iterator upper_bound(const value_type& val) const
+    {
+        return std::upper_bound(begin(), end(), val, comp_);
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    const_iterator upper_bound(const K& key) const
+    {
+        return std::upper_bound(begin(), end(), key, comp_);
+    }
+
+    std::pair<const_iterator, const_iterator> equal_range(const value_type& val) const
+    {
+        return std::equal_range(begin(), end(), val, comp_);
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    std::pair<const_iterator, const_iterator> equal_range(const K& key) const
+    {
+        return std::equal_range(begin(), end(), key, comp_);
+    }
+
+    key_compare key_comp() const
+    {
+        return comp_;
+    }
+
+    value_compare value_comp() const
+    {
+        return comp_;
+    }
+
+private:
+    key_compare         comp_;
+    const value_type*   data_;
+    size_type           size_;
+};  // class sorted_view
+
+}  // namespace eos
+
+#endif  // EOS_SORTED_VIEW_H_
@@ -5,6 +5,8 @@
 #include <vector>
 #include <algorithm>
 #include <functional>
+#include <memory>
+#include <utility>
 
 namespace eos
 {
@@ -17,14 +19,15 @@ template <
 class unique_vector
 {
     typedef          std::vector<T, Alloc>                  storage_type;
+    typedef          std::allocator_traits<Alloc>           alloc_traits;
 public:
     typedef typename storage_type::value_type               value_type;
     typedef          Compare                                value_compare;
     typedef typename storage_type::allocator_type           allocator_type;
-    typedef typename allocator_type::reference              reference;
-    typedef typename allocator_type::const_reference        const_reference;
-    typedef typename allocator_type::pointer                pointer;
-    typedef typename allocator_type::const_pointer          const_pointer;
+    typedef          value_type&                            reference;
+    typedef          const value_type&                      const_reference;
+    typedef typename alloc_traits::pointer                  pointer;
+    typedef typename alloc_traits::const_pointer            const_pointer;
     typedef typename storage_type::iterator                 iterator;
     typedef typename storage_type::const_iterator           const_iterator;
     typedef typename storage_type::reverse_iterator         reverse_iterator;
@@ -207,6 +210,23 @@ public:
         storage_.pop_back();
     }
 
+    void clear() noexcept
+    {
+        storage_.clear();
+    }
+
+    void swap(unique_vector& other)
+    {
+        using std::swap;
+        swap(comp_, other.comp_);
+        storage_.swap(other.storage_);
+    }
+
+    allocator_type get_allocator() const
+    {
+        return storage_.get_allocator();
+    }
+
     iterator find(const value_type& val)
     {
         iterator first = begin(), last = end();
@@ -0,0 +1,114 @@
+/**
+ * @author Gracjan Olbinski <gracjan.olbinski@gmail.com>
+ */
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include "eos/arena_allocator.h"
+#include "eos/linear_set.h"
+#include "eos/small_linear_set.h"
+#include "eos/unique_vector.h"
+
+namespace eos
+{
+namespace tests
+{
+
+namespace
+{
+
+struct ordered_by
+{
+    explicit ordered_by(bool descending = false)
+    : descending(descending)
+    {
+    }
+
+    bool operator()(int lhs, int rhs) const
+    {
+        return descending ? rhs < lhs : lhs < rhs;
+    }
+
+    bool descending;
+};
+
+static_assert(std::is_nothrow_move_constructible<eos::linear_set<int> >::value,
+              "linear_set<int> should be nothrow move constructible");
+static_assert(std::is_nothrow_move_assignable<eos::linear_set<int> >::value,
+              "linear_set<int> should be nothrow move assignable");
+
+}  // namespace
+
+TEST(monotonic_buffer_should, bump_allocate_aligned_memory)
+{
+    char storage[64];
+    eos::monotonic_buffer sut(storage, sizeof(storage));
+    void* first = sut.allocate(3, 1);
+    void* second = sut.allocate(8, 8);
+    ASSERT_EQ(static_cast<void*>(storage), first);
+    ASSERT_EQ(0u, reinterpret_cast<std::uintptr_t>(second) % 8);
+    ASSERT_TRUE(second >= static_cast<void*>(storage + 3) && second < static_cast<void*>(storage + 64));
+
+    void* spilled = sut.allocate(1000, 16);
+    ASSERT_EQ(0u, reinterpret_cast<std::uintptr_t>(spilled) % 16);
+    ASSERT_FALSE(spilled >= static_cast<void*>(storage) && spilled < static_cast<void*>(storage + 64));
+
+    sut.release();
+    ASSERT_EQ(static_cast<void*>(storage), sut.allocate(1, 1));
+}
+
+TEST(arena_allocator_should, back_linear_set_storage)
+{
+    typedef eos::arena_allocator<int> allocator;
+    eos::monotonic_buffer arena(256);
+    eos::linear_set<int, std::less<int>, allocator> sut{ std::less<int>(), allocator(arena) };
+    for ( int i = 1000; i > 0; --i )
+    {
+        sut.insert(i);
+    }
+    ASSERT_EQ(1000u, sut.size());
+    ASSERT_EQ(&arena, sut.get_allocator().buffer());
+
+    eos::linear_set<int, std::less<int>, allocator> copy(sut);
+    ASSERT_EQ(&arena, copy.get_allocator().buffer());
+
+    eos::monotonic_buffer other_arena;
+    eos::linear_set<int, std::less<int>, allocator> moved(std::move(copy), allocator(other_arena));
+    ASSERT_EQ(&other_arena, moved.get_allocator().buffer());
+    ASSERT_TRUE(copy.empty());
+    ASSERT_TRUE(std::equal(sut.begin(), sut.end(), moved.begin()));
+
+    eos::small_linear_set<int, 8, std::less<int>, allocator> small{ std::less<int>(), allocator(arena) };
+    small.insert(sut.begin(), sut.end());
+    ASSERT_EQ(1000u, small.size());
+
+    eos::unique_vector<int, std::equal_to<int>, allocator> vector{ std::equal_to<int>(), allocator(arena) };
+    ASSERT_EQ(&arena, vector.get_allocator().buffer());
+}
+
+TEST(linear_set_should, swap_and_move_comparators_with_keys)
+{
+    typedef eos::linear_set<int, ordered_by> set_type;
+    set_type ascending({ 1, 2, 3 });
+    set_type descending({ 1, 2, 3 }, ordered_by(true));
+    swap(ascending, descending);
+    ascending.insert(0);
+    descending.insert(0);
+    ASSERT_EQ(3, *ascending.begin());
+    ASSERT_EQ(0, *descending.begin());
+
+    set_type moved(std::move(descending));
+    ASSERT_TRUE(descending.empty());
+    moved.insert(4);
+    ASSERT_EQ(4, *moved.rbegin());
+    ascending = std::move(moved);
+    ascending.insert(-1);
+    ASSERT_EQ(-1, *ascending.begin());
+    ASSERT_EQ(6u, ascending.size());
+}
+
+}  // namespace tests
+}  // namespace eos
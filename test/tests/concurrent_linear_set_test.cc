@@ -0,0 +1,99 @@
+/**
+ * @author Gracjan Olbinski <gracjan.olbinski@gmail.com>
+ */
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "eos/concurrent_linear_set.h"
+
+namespace eos
+{
+namespace tests
+{
+
+TEST(concurrent_linear_set_should, give_readers_consistent_snapshots)
+{
+    eos::concurrent_linear_set<int> sut(8);
+    std::atomic<bool> done(false);
+    std::atomic<int> failures(0);
+    std::vector<std::thread> readers;
+    for ( int i = 0; i < 4; ++i )
+    {
+        readers.push_back(std::thread([&]
+        {
+            std::size_t previous = 0;
+            while ( !done.load() )
+            {
+                eos::concurrent_linear_set<int>::snapshot snapshot = sut.read();
+                std::size_t size = snapshot->size();
+                bool dense = size == 0 || ( *snapshot->begin() == 0 && *snapshot->rbegin() == static_cast<int>(size) - 1 );
+                if ( size < previous || !dense )
+                {
+                    ++failures;
+                }
+                previous = size;
+            }
+        }));
+    }
+    for ( int i = 0; i < 2000; i += 4 )
+    {
+        sut.update([i](eos::linear_set<int>& set)
+        {
+            for ( int j = i + 3; j >= i; --j )
+            {
+                set.insert(j);
+            }
+        });
+    }
+    done = true;
+    for ( std::size_t i = 0; i < readers.size(); ++i )
+    {
+        readers[i].join();
+    }
+    ASSERT_EQ(0, failures.load());
+    ASSERT_EQ(2000u, sut.size());
+    ASSERT_EQ(1u, sut.count(1999));
+
+    sut.reclaim();
+    ASSERT_EQ(0u, sut.retired());
+}
+
+TEST(concurrent_linear_set_should, keep_pinned_version_alive)
+{
+    eos::concurrent_linear_set<int> sut(eos::linear_set<int>({ 1, 2, 3 }), 2);
+    eos::concurrent_linear_set<int>::snapshot pinned = sut.read();
+    ASSERT_TRUE(sut.insert(4));
+    ASSERT_EQ(1u, sut.erase(1));
+    ASSERT_EQ(3u, pinned->size());
+    ASSERT_EQ(1u, pinned->count(1));
+    ASSERT_EQ(2u, sut.retired());
+    ASSERT_EQ(0u, sut.count(1));
+}
+
+TEST(concurrent_linear_set_should, hold_more_snapshots_than_reader_slots)
+{
+    eos::concurrent_linear_set<int> sut(eos::linear_set<int>({ 1, 2, 3 }), 2);
+    std::vector<eos::concurrent_linear_set<int>::snapshot> pinned;
+    for ( int i = 0; i < 5; ++i )
+    {
+        pinned.push_back(sut.read());
+        ASSERT_TRUE(sut.insert(10 + i));
+    }
+    ASSERT_EQ(8u, sut.size());
+    ASSERT_EQ(1u, sut.count(14));
+    for ( int i = 0; i < 5; ++i )
+    {
+        ASSERT_EQ(3u + i, pinned[i]->size());
+    }
+    ASSERT_EQ(5u, sut.retired());
+
+    pinned.clear();
+    sut.reclaim();
+    ASSERT_EQ(0u, sut.retired());
+    ASSERT_EQ(8u, sut.size());
+}
+
+}  // namespace tests
+}  // namespace eos
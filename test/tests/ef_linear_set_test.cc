@@ -0,0 +1,66 @@
+/**
+ * @author Gracjan Olbinski <gracjan.olbinski@gmail.com>
+ */
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "eos/ef_linear_set.h"
+
+namespace eos
+{
+namespace tests
+{
+
+TEST(ef_linear_set_should, match_linear_set)
+{
+    std::mt19937_64 random(7);
+    for ( std::uint64_t spread : { 1ull, 3ull, 1000ull, 1ull << 40, ~0ull } )
+    {
+        for ( std::size_t size : { 0, 1, 2, 255, 256, 257, 3000 } )
+        {
+            std::vector<std::uint64_t> keys(size);
+            for ( std::uint64_t& key : keys )
+            {
+                key = random() % spread;
+            }
+            eos::linear_set<std::uint64_t> source(keys.begin(), keys.end());
+            eos::ef_linear_set<std::uint64_t> sut(source);
+            ASSERT_EQ(source.size(), sut.size());
+            ASSERT_TRUE(std::equal(source.begin(), source.end(), sut.begin()));
+            for ( std::size_t i = 0; i < source.size(); ++i )
+            {
+                ASSERT_EQ(source.begin()[i], sut.nth(i));
+            }
+            for ( std::size_t i = 0; i < 200; ++i )
+            {
+                std::uint64_t key = ( i % 2 == 0 || source.empty() ) ? random() % spread + i % 3
+                                                                     : source.begin()[random() % source.size()];
+                ASSERT_EQ(std::distance(source.begin(), source.lower_bound(key)),
+                          std::distance(sut.begin(), sut.lower_bound(key)));
+                ASSERT_EQ(std::distance(source.begin(), source.upper_bound(key)),
+                          std::distance(sut.begin(), sut.upper_bound(key)));
+                ASSERT_EQ(source.count(key), sut.count(key));
+            }
+        }
+    }
+}
+
+TEST(ef_linear_set_should, use_a_few_bits_per_key)
+{
+    std::vector<std::uint32_t> keys;
+    for ( std::uint32_t i = 0; i < 100000; ++i )
+    {
+        keys.push_back(i * 37 + i % 5);
+    }
+    eos::ef_linear_set<std::uint32_t> sut(keys.begin(), keys.end());
+    ASSERT_LT(sut.memory_usage() * 8, keys.size() * 10);
+    ASSERT_EQ(keys.back(), sut.nth(keys.size() - 1));
+    ASSERT_EQ(38u, *sut.find(38));
+    ASSERT_EQ(sut.end(), sut.find(39));
+    ASSERT_EQ(76u, *sut.lower_bound(39));
+}
+
+}  // namespace tests
+}  // namespace eos
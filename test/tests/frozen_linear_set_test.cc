@@ -0,0 +1,59 @@
+/**
+ * @author Gracjan Olbinski <gracjan.olbinski@gmail.com>
+ */
+
+#include <gtest/gtest.h>
+#include "eos/frozen_linear_set.h"
+
+namespace eos
+{
+namespace tests
+{
+
+TEST(frozen_linear_set_should, iterate_in_sorted_order)
+{
+    for ( int size = 0; size < 70; ++size )
+    {
+        eos::linear_set<int> source;
+        for ( int i = 0; i < size; ++i )
+        {
+            source.insert(3 * i);
+        }
+        eos::frozen_linear_set<int> sut(source);
+        ASSERT_EQ(std::vector<int>(source.begin(), source.end()), std::vector<int>(sut.begin(), sut.end()));
+        ASSERT_EQ(std::vector<int>(source.rbegin(), source.rend()), std::vector<int>(sut.rbegin(), sut.rend()));
+    }
+}
+
+TEST(frozen_linear_set_should, match_linear_set_lookups)
+{
+    for ( int size = 0; size < 70; ++size )
+    {
+        eos::linear_set<int> source;
+        for ( int i = 0; i < size; ++i )
+        {
+            source.insert(3 * i);
+        }
+        eos::frozen_linear_set<int> sut(source);
+        for ( int key = -1; key < 3 * size + 2; ++key )
+        {
+            ASSERT_EQ(std::distance(source.begin(), source.lower_bound(key)),
+                      std::distance(sut.begin(), sut.lower_bound(key)));
+            ASSERT_EQ(std::distance(source.begin(), source.upper_bound(key)),
+                      std::distance(sut.begin(), sut.upper_bound(key)));
+            ASSERT_EQ(source.count(key), sut.count(key));
+            ASSERT_EQ(source.find(key) == source.end(), sut.find(key) == sut.end());
+        }
+    }
+}
+
+TEST(frozen_linear_set_should, build_from_unsorted_range)
+{
+    std::vector<int> input{7, 3, 9, 3, 1};
+    eos::frozen_linear_set<int> sut(input.begin(), input.end());
+    ASSERT_EQ(std::vector<int>({1, 3, 7, 9}), std::vector<int>(sut.begin(), sut.end()));
+    ASSERT_EQ(7, *sut.find(7));
+}
+
+}  // namespace tests
+}  // namespace eos
@@ -0,0 +1,69 @@
+/**
+ * @author Gracjan Olbinski <gracjan.olbinski@gmail.com>
+ */
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+#include "eos/learned_index.h"
+#include "eos/linear_set.h"
+
+namespace eos
+{
+namespace tests
+{
+
+TEST(learned_index_should, match_binary_search)
+{
+    std::mt19937 random(7);
+    eos::linear_set<int> set;
+    int key = -100000;
+    for ( int i = 0; i < 50000; ++i )
+    {
+        key += 1 + ( ( i / 1000 ) % 2 == 0 ? random() % 4 : random() % 400 );
+        set.insert(key);
+    }
+    eos::learned_index<int> sut(set.view(), 8);
+    ASSERT_LE(sut.max_error(), 9u);
+    ASSERT_GT(sut.segment_count(), 1u);
+    ASSERT_LT(sut.segment_count(), set.size() / 8);
+    ASSERT_GT(sut.size_in_bytes(), sut.segment_count() * sizeof(int));
+    const eos::linear_set<int>& view = set;
+    for ( int probe = -100100; probe < key + 100; probe += 7 )
+    {
+        ASSERT_EQ(view.lower_bound(probe) - view.begin(), sut.lower_bound(probe) - sut.begin());
+        ASSERT_EQ(view.count(probe), sut.count(probe));
+    }
+    ASSERT_EQ(sut.end(), sut.upper_bound(key));
+
+    set.insert(key + 1);
+    sut.rebuild(set.view());
+    ASSERT_EQ(set.size(), sut.size());
+    ASSERT_EQ(1u, sut.count(key + 1));
+}
+
+TEST(learned_index_should, handle_extreme_and_floating_keys)
+{
+    typedef std::numeric_limits<std::int64_t> limits;
+    eos::linear_set<std::int64_t> wide = { limits::min(), -5, 0, 3, 1000000007, limits::max() };
+    eos::learned_index<std::int64_t> sut(wide.view(), 1);
+    ASSERT_EQ(1u, sut.count(limits::min()));
+    ASSERT_EQ(1u, sut.count(limits::max()));
+    ASSERT_EQ(3, sut.lower_bound(1) - sut.begin());
+    ASSERT_EQ(5, sut.lower_bound(1000000008) - sut.begin());
+
+    eos::linear_set<double> reals = { -1.5, 0.25, 0.5, 2.0, 1e300 };
+    eos::learned_index<double> real_index(reals.view());
+    ASSERT_EQ(2, real_index.lower_bound(0.3) - real_index.begin());
+    ASSERT_EQ(real_index.end(), real_index.find(3.0));
+    ASSERT_EQ(1u, real_index.count(1e300));
+
+    eos::learned_index<int> empty;
+    ASSERT_EQ(empty.end(), empty.lower_bound(1));
+    ASSERT_EQ(0u, empty.segment_count());
+}
+
+}  // namespace tests
+}  // namespace eos
@@ -0,0 +1,114 @@
+/**
+ * @author Gracjan Olbinski <gracjan.olbinski@gmail.com>
+ */
+
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include "eos/linear_map.h"
+
+namespace eos
+{
+namespace tests
+{
+
+TEST(linear_map_should, behave_like_std_map)
+{
+    std::mt19937 random(17);
+    std::map<int, int> expected;
+    eos::linear_map<int, int> sut;
+    for ( int i = 0; i < 5000; ++i )
+    {
+        int key = random() % 600, value = random() % 100;
+        switch ( random() % 5 )
+        {
+        case 0:
+            ASSERT_EQ(expected.erase(key), sut.erase(key));
+            break;
+        case 1:
+            expected[key] += value;
+            sut[key] += value;
+            break;
+        case 2:
+            ASSERT_EQ(expected.insert(std::make_pair(key, value)).second,
+                      sut.insert(std::make_pair(key, value)).second);
+            break;
+        case 3:
+            expected[key] = value;
+            ASSERT_EQ(value, sut.insert_or_assign(key, value).first->second);
+            break;
+        default:
+            ASSERT_EQ(expected.count(key), sut.count(key));
+            ASSERT_EQ(std::distance(expected.begin(), expected.lower_bound(key)),
+                      sut.lower_bound(key) - sut.begin());
+            break;
+        }
+    }
+    ASSERT_EQ(expected.size(), sut.size());
+    std::map<int, int>::const_iterator it = expected.begin();
+    for ( eos::linear_map<int, int>::const_iterator jt = sut.begin(); jt != sut.end(); ++jt, ++it )
+    {
+        ASSERT_EQ(it->first, jt->first);
+        ASSERT_EQ(it->second, jt->second);
+    }
+}
+
+TEST(linear_map_should, keep_existing_values_on_bulk_insert)
+{
+    eos::linear_map<int, std::string> sut = { { 5, "five" }, { 1, "one" }, { 5, "FIVE" } };
+    ASSERT_EQ(2u, sut.size());
+    ASSERT_EQ("five", sut.at(5));
+
+    std::vector<std::pair<int, std::string> > batch = { { 3, "three" }, { 1, "ONE" }, { 9, "nine" }, { 3, "THREE" } };
+    sut.insert(batch.begin(), batch.end());
+    ASSERT_EQ(4u, sut.size());
+    ASSERT_EQ("one", sut.at(1));
+    ASSERT_EQ("three", sut.at(3));
+    ASSERT_EQ("nine", sut.rbegin()->second);
+    ASSERT_THROW(sut.at(2), std::out_of_range);
+
+    std::vector<int> keys(sut.keys().begin(), sut.keys().end());
+    ASSERT_EQ(std::vector<int>({ 1, 3, 5, 9 }), keys);
+}
+
+TEST(linear_map_should, try_emplace_without_moving_from_value_on_hit)
+{
+    eos::linear_map<std::string, std::unique_ptr<int> > sut;
+    std::unique_ptr<int> value(new int(1));
+    ASSERT_TRUE(sut.try_emplace("a", std::move(value)).second);
+    std::unique_ptr<int> other(new int(2));
+    ASSERT_FALSE(sut.try_emplace("a", std::move(other)).second);
+    ASSERT_TRUE(other != nullptr);
+    ASSERT_EQ(1, *sut.find("a")->second);
+    sut.erase(sut.begin());
+    ASSERT_TRUE(sut.empty());
+}
+
+TEST(linear_map_should, store_bool_values)
+{
+    eos::linear_map<int, bool> sut = { { 4, true }, { 2, false }, { 4, false } };
+    ASSERT_EQ(2u, sut.size());
+    ASSERT_TRUE(sut.at(4));
+    ASSERT_FALSE(sut[2]);
+
+    sut[2] = true;
+    sut[7] = false;
+    sut.insert_or_assign(4, false);
+    bool& value = sut.find(7)->second;
+    value = true;
+
+    std::vector<std::pair<int, bool> > batch = { { 9, true }, { 1, false }, { 7, false } };
+    sut.insert(batch.begin(), batch.end());
+    std::vector<std::pair<int, bool> > entries;
+    for ( eos::linear_map<int, bool>::const_iterator it = sut.begin(); it != sut.end(); ++it )
+    {
+        entries.push_back(std::make_pair(it->first, it->second));
+    }
+    std::vector<std::pair<int, bool> > expected = { { 1, false }, { 2, true }, { 4, false }, { 7, true }, { 9, true } };
+    ASSERT_EQ(expected, entries);
+}
+
+}  // namespace tests
+}  // namespace eos
@@ -0,0 +1,97 @@
+/**
+ * @author Gracjan Olbinski <gracjan.olbinski@gmail.com>
+ */
+
+#include <gtest/gtest.h>
+#include <random>
+#include <set>
+#include <vector>
+#include "eos/linear_multiset.h"
+
+namespace eos
+{
+namespace tests
+{
+
+TEST(linear_multiset_should, behave_like_std_multiset)
+{
+    std::mt19937 random(23);
+    std::multiset<int> expected;
+    eos::linear_multiset<int> sut;
+    eos::compact_linear_multiset<int> compact;
+    for ( int i = 0; i < 4000; ++i )
+    {
+        int key = random() % 50;
+        switch ( random() % 4 )
+        {
+        case 0:
+            ASSERT_EQ(expected.erase(key), sut.erase(key));
+            ASSERT_EQ(expected.size(), sut.size());
+            compact.erase(key);
+            break;
+        case 1:
+            {
+                std::vector<int> batch(random() % 20);
+                for ( int& value : batch )
+                {
+                    value = random() % 60;
+                }
+                expected.insert(batch.begin(), batch.end());
+                sut.insert(batch.begin(), batch.end());
+                compact.insert(batch.begin(), batch.end());
+            }
+            break;
+        default:
+            expected.insert(key);
+            ASSERT_EQ(key, *sut.insert(key));
+            ASSERT_EQ(key, *compact.insert(key));
+            break;
+        }
+        ASSERT_EQ(expected.count(key), sut.count(key));
+        ASSERT_EQ(expected.count(key), compact.count(key));
+    }
+    ASSERT_EQ(expected.size(), sut.size());
+    ASSERT_EQ(expected.size(), compact.size());
+    ASSERT_TRUE(std::equal(expected.begin(), expected.end(), sut.begin()));
+    ASSERT_TRUE(std::equal(expected.begin(), expected.end(), compact.begin()));
+    ASSERT_TRUE(std::equal(expected.rbegin(), expected.rend(), compact.rbegin()));
+}
+
+TEST(linear_multiset_should, keep_equivalent_keys_in_insertion_order)
+{
+    typedef std::pair<int, int> entry;
+    auto by_first = [](const entry& lhs, const entry& rhs)
+    {
+        return lhs.first < rhs.first;
+    };
+    eos::linear_multiset<entry, decltype(by_first)> sut(by_first);
+    sut.insert(entry(1, 0));
+    sut.insert(entry(0, 1));
+    sut.insert(entry(1, 2));
+    std::vector<entry> batch = { entry(1, 3), entry(0, 4) };
+    sut.insert(batch.begin(), batch.end());
+    std::vector<entry> expected = { entry(0, 1), entry(0, 4), entry(1, 0), entry(1, 2), entry(1, 3) };
+    ASSERT_EQ(expected, std::vector<entry>(sut.begin(), sut.end()));
+}
+
+TEST(compact_linear_multiset_should, store_each_distinct_key_once)
+{
+    eos::compact_linear_multiset<int> sut;
+    for ( int i = 0; i < 100000; ++i )
+    {
+        sut.insert(i % 7);
+    }
+    ASSERT_EQ(100000u, sut.size());
+    ASSERT_EQ(7u, sut.distinct_size());
+    ASSERT_EQ(14286u, sut.count(0));
+    ASSERT_EQ(14286, std::distance(sut.equal_range(0).first, sut.equal_range(0).second));
+
+    ASSERT_EQ(10u, sut.erase(3, 10));
+    sut.erase(sut.find(3));
+    ASSERT_EQ(14286u - 11u, sut.count(3));
+    ASSERT_EQ(sut.end(), sut.find(9));
+    ASSERT_EQ(sut.size() - 14286u, static_cast<std::size_t>(std::distance(sut.upper_bound(0), sut.end())));
+}
+
+}  // namespace tests
+}  // namespace eos
@@ -3,6 +3,11 @@
  */
 
 #include <gtest/gtest.h>
+#include <sstream>
+#include <iterator>
+#include <list>
+#include <string>
+#include <cstdint>
 #include "eos/linear_set.h"
 
 namespace eos
@@ -10,11 +15,465 @@ namespace eos
 namespace tests
 {
 
+struct move_only_key
+{
+    explicit move_only_key(int v) : value(v) {}
+    move_only_key(move_only_key&&) = default;
+    move_only_key& operator=(move_only_key&&) = default;
+
+    bool operator<(const move_only_key& other) const
+    {
+        return value < other.value;
+    }
+
+    int value;
+};
+
+struct prefix
+{
+    std::string value;
+};
+
+struct transparent_less
+{
+    typedef void is_transparent;
+
+    bool operator()(const std::string& lhs, const std::string& rhs) const
+    {
+        return lhs < rhs;
+    }
+
+    bool operator()(const std::string& lhs, const char* rhs) const
+    {
+        return lhs.compare(rhs) < 0;
+    }
+
+    bool operator()(const char* lhs, const std::string& rhs) const
+    {
+        return rhs.compare(lhs) > 0;
+    }
+
+    bool operator()(const std::string& lhs, const prefix& rhs) const
+    {
+        return lhs.compare(0, rhs.value.size(), rhs.value) < 0;
+    }
+
+    bool operator()(const prefix& lhs, const std::string& rhs) const
+    {
+        return rhs.compare(0, lhs.value.size(), lhs.value) > 0;
+    }
+};
+
 TEST(linear_set_should, insert_unique_values_in_order)
 {
     eos::linear_set<int> sut{10, 9, 8, 7, 6, 5, 4, 3, 2, 1};
     ASSERT_TRUE(std::is_sorted(sut.begin(), sut.end()));
 }
 
+TEST(linear_set_should, drop_duplicates_when_constructed_from_range)
+{
+    std::vector<int> input{5, 3, 5, 1, 3, 9, 1};
+    eos::linear_set<int> sut(input.begin(), input.end());
+    ASSERT_EQ(std::vector<int>({1, 3, 5, 9}), std::vector<int>(sut.begin(), sut.end()));
+}
+
+TEST(linear_set_should, keep_first_of_equivalent_values_when_constructed_from_range)
+{
+    std::vector<std::pair<int, int>> input{{2, 0}, {1, 1}, {2, 2}, {1, 3}};
+    auto by_first = [](const std::pair<int, int>& lhs, const std::pair<int, int>& rhs)
+    {
+        return lhs.first < rhs.first;
+    };
+    eos::linear_set<std::pair<int, int>, decltype(by_first)> sut(input.begin(), input.end(), by_first);
+    ASSERT_EQ(2u, sut.size());
+    ASSERT_EQ(1, sut.begin()->second);
+    ASSERT_EQ(0, (++sut.begin())->second);
+}
+
+TEST(linear_set_should, construct_from_single_pass_range)
+{
+    std::istringstream input("4 4 2 8 2");
+    eos::linear_set<int> sut{std::istream_iterator<int>(input), std::istream_iterator<int>()};
+    ASSERT_EQ(std::vector<int>({2, 4, 8}), std::vector<int>(sut.begin(), sut.end()));
+}
+
+TEST(linear_set_should, drop_duplicates_from_initializer_list)
+{
+    eos::linear_set<int> sut{3, 1, 3, 2, 1};
+    ASSERT_EQ(std::vector<int>({1, 2, 3}), std::vector<int>(sut.begin(), sut.end()));
+}
+
+TEST(linear_set_should, merge_inserted_range_without_duplicates)
+{
+    eos::linear_set<int> sut{1, 4, 7, 10};
+    std::vector<int> batch{8, 2, 4, 12, 2, 0};
+    sut.insert(batch.begin(), batch.end());
+    ASSERT_EQ(std::vector<int>({0, 1, 2, 4, 7, 8, 10, 12}), std::vector<int>(sut.begin(), sut.end()));
+}
+
+TEST(linear_set_should, keep_existing_values_when_inserting_equivalent_range)
+{
+    auto by_first = [](const std::pair<int, int>& lhs, const std::pair<int, int>& rhs)
+    {
+        return lhs.first < rhs.first;
+    };
+    eos::linear_set<std::pair<int, int>, decltype(by_first)> sut({{1, 0}, {3, 0}}, by_first);
+    std::vector<std::pair<int, int>> batch{{3, 1}, {2, 1}, {4, 1}};
+    sut.insert(batch.begin(), batch.end());
+    ASSERT_EQ(4u, sut.size());
+    ASSERT_EQ(0, sut.lower_bound(std::make_pair(3, -1))->second);
+    ASSERT_EQ(1, sut.lower_bound(std::make_pair(2, -1))->second);
+}
+
+TEST(linear_set_should, insert_and_emplace_move_only_values)
+{
+    eos::linear_set<move_only_key> sut;
+    ASSERT_TRUE(sut.insert(move_only_key(5)).second);
+    ASSERT_TRUE(sut.emplace(1).second);
+    ASSERT_TRUE(sut.emplace_hint(sut.end(), 3) != sut.end());
+    ASSERT_FALSE(sut.emplace(5).second);
+    ASSERT_EQ(3u, sut.size());
+    ASSERT_EQ(1, sut.begin()->value);
+    ASSERT_EQ(3, (sut.begin() + 1)->value);
+    ASSERT_EQ(5, (sut.begin() + 2)->value);
+}
+
+TEST(linear_set_should, insert_at_correct_position_regardless_of_hint)
+{
+    eos::linear_set<int> sut{10, 20, 30, 40, 50, 60, 70, 80};
+    sut.insert(sut.begin(), 75);
+    sut.insert(sut.end(), 5);
+    sut.insert(sut.begin() + 4, 45);
+    sut.insert(sut.begin() + 4, 35);
+    ASSERT_EQ(std::vector<int>({5, 10, 20, 30, 35, 40, 45, 50, 60, 70, 75, 80}),
+              std::vector<int>(sut.begin(), sut.end()));
+}
+
+TEST(linear_set_should, return_existing_value_when_hinted_insert_finds_duplicate)
+{
+    eos::linear_set<int> sut{10, 20, 30, 40};
+    ASSERT_EQ(30, *sut.insert(sut.begin(), 30));
+    ASSERT_EQ(10, *sut.insert(sut.end(), 10));
+    ASSERT_EQ(20, *sut.insert(sut.begin() + 2, 20));
+    ASSERT_EQ(4u, sut.size());
+}
+
+TEST(linear_set_should, accept_nearly_sorted_input_through_inserter)
+{
+    std::vector<int> input{1, 2, 4, 3, 5, 5, 7, 6, 0};
+    eos::linear_set<int> sut;
+    std::copy(input.begin(), input.end(), std::inserter(sut, sut.end()));
+    ASSERT_EQ(std::vector<int>({0, 1, 2, 3, 4, 5, 6, 7}), std::vector<int>(sut.begin(), sut.end()));
+}
+
+TEST(linear_set_should, find_with_transparent_comparator)
+{
+    const eos::linear_set<std::string, transparent_less> sut{"beta", "alpha", "gamma"};
+    ASSERT_EQ("beta", *sut.find("beta"));
+    ASSERT_TRUE(sut.find("delta") == sut.end());
+    ASSERT_EQ(1u, sut.count("gamma"));
+    ASSERT_EQ("gamma", *sut.lower_bound("delta"));
+    ASSERT_EQ("gamma", *sut.upper_bound("beta"));
+}
+
+TEST(linear_set_should, count_and_erase_all_keys_equivalent_to_transparent_key)
+{
+    eos::linear_set<std::string, transparent_less> sut{"apple", "apricot", "banana", "avocado", "cherry"};
+    ASSERT_EQ(3u, sut.count(prefix{"a"}));
+    ASSERT_EQ(2u, sut.count(prefix{"ap"}));
+    ASSERT_EQ(2u, sut.erase(prefix{"ap"}));
+    ASSERT_EQ(std::vector<std::string>({"avocado", "banana", "cherry"}),
+              std::vector<std::string>(sut.begin(), sut.end()));
+
+    sut.defer_sort(4);
+    sut.insert("apex");
+    sut.insert("aardvark");
+    const eos::linear_set<std::string, transparent_less>& view = sut;
+    ASSERT_EQ(3u, view.count(prefix{"a"}));
+    ASSERT_EQ("apex", *view.find(prefix{"ap"}));
+    ASSERT_EQ(2u, sut.pending());
+}
+
+TEST(linear_set_should, reject_duplicates_while_sort_is_deferred)
+{
+    eos::linear_set<int> sut{5, 15};
+    sut.defer_sort(4);
+    ASSERT_TRUE(sut.insert(10).second);
+    ASSERT_TRUE(sut.insert(1).second);
+    ASSERT_FALSE(sut.insert(15).second);
+    ASSERT_FALSE(sut.insert(10).second);
+    ASSERT_EQ(2u, sut.pending());
+
+    const eos::linear_set<int>& view = sut;
+    ASSERT_EQ(1u, view.count(10));
+    ASSERT_EQ(0u, view.count(11));
+    ASSERT_EQ(2u, sut.pending());
+    ASSERT_EQ(4u, sut.size());
+    ASSERT_EQ(0u, sut.pending());
+    ASSERT_EQ(std::vector<int>({1, 5, 10, 15}), std::vector<int>(view.begin(), view.end()));
+}
+
+TEST(linear_set_should, merge_deferred_inserts_on_lookup)
+{
+    eos::linear_set<int> sut;
+    sut.defer_sort(3);
+    for ( int val : {9, 2, 7, 4, 4, 8, 1} )
+    {
+        sut.insert(val);
+    }
+    ASSERT_NE(0u, sut.pending());
+    const eos::linear_set<int>& view = sut;
+    ASSERT_EQ(7, *view.find(7));
+    ASSERT_NE(0u, sut.pending());
+    ASSERT_EQ(7, *view.lower_bound(7));
+    ASSERT_EQ(0u, sut.pending());
+    ASSERT_EQ(std::vector<int>({1, 2, 4, 7, 8, 9}), std::vector<int>(view.begin(), view.end()));
+}
+
+TEST(linear_set_should, erase_deferred_inserts)
+{
+    eos::linear_set<int> sut{1, 2, 3};
+    sut.defer_sort(8);
+    auto it = sut.insert(0).first;
+    sut.erase(it);
+    ASSERT_EQ(0u, sut.pending());
+    sut.insert(5);
+    sut.defer_sort(0);
+    ASSERT_EQ(std::vector<int>({1, 2, 3, 5}), std::vector<int>(sut.begin(), sut.end()));
+}
+
+TEST(linear_set_should, compute_set_algebra)
+{
+    const eos::linear_set<int> lhs{1, 2, 3, 5, 8, 13};
+    const eos::linear_set<int> rhs{2, 3, 4, 8, 16};
+    eos::linear_set<int> sut = lhs | rhs;
+    ASSERT_EQ(std::vector<int>({1, 2, 3, 4, 5, 8, 13, 16}), std::vector<int>(sut.begin(), sut.end()));
+    sut = lhs & rhs;
+    ASSERT_EQ(std::vector<int>({2, 3, 8}), std::vector<int>(sut.begin(), sut.end()));
+    sut = lhs - rhs;
+    ASSERT_EQ(std::vector<int>({1, 5, 13}), std::vector<int>(sut.begin(), sut.end()));
+    sut = lhs ^ rhs;
+    ASSERT_EQ(std::vector<int>({1, 4, 5, 13, 16}), std::vector<int>(sut.begin(), sut.end()));
+}
+
+TEST(linear_set_should, compute_set_algebra_in_place_for_skewed_sizes)
+{
+    eos::linear_set<int> large, small{-1, 0, 300, 301, 999, 1500, 4000};
+    for ( int i = 0; i < 2000; ++i )
+    {
+        large.insert(i * 2);
+    }
+    std::vector<int> expected;
+    std::set_intersection(large.begin(), large.end(), small.begin(), small.end(), std::back_inserter(expected));
+
+    eos::linear_set<int> sut(large);
+    sut &= small;
+    ASSERT_EQ(expected, std::vector<int>(sut.begin(), sut.end()));
+    sut = small;
+    sut &= large;
+    ASSERT_EQ(expected, std::vector<int>(sut.begin(), sut.end()));
+
+    expected.clear();
+    std::set_difference(large.begin(), large.end(), small.begin(), small.end(), std::back_inserter(expected));
+    sut = large;
+    sut -= small;
+    ASSERT_EQ(expected, std::vector<int>(sut.begin(), sut.end()));
+    sut = set_difference(large, small);
+    ASSERT_EQ(expected, std::vector<int>(sut.begin(), sut.end()));
+
+    expected.clear();
+    std::set_difference(small.begin(), small.end(), large.begin(), large.end(), std::back_inserter(expected));
+    sut = small;
+    sut -= large;
+    ASSERT_EQ(expected, std::vector<int>(sut.begin(), sut.end()));
+
+    sut = large;
+    sut |= small;
+    ASSERT_EQ(large.size() + 4, sut.size());
+}
+
+TEST(linear_set_should, erase_values_matching_predicate)
+{
+    eos::linear_set<int> sut{1, 2, 3, 4, 5, 6, 7};
+    ASSERT_EQ(3u, erase_if(sut, [](int val) { return val % 2 == 0; }));
+    ASSERT_EQ(std::vector<int>({1, 3, 5, 7}), std::vector<int>(sut.begin(), sut.end()));
+}
+
+TEST(linear_set_should, erase_sorted_batch_of_keys)
+{
+    eos::linear_set<int> sut;
+    for ( int i = 0; i < 1000; ++i )
+    {
+        sut.insert(i);
+    }
+    std::list<int> batch{-5, 3, 3, 500, 998, 1200};
+    ASSERT_EQ(3u, sut.erase_keys(batch.begin(), batch.end()));
+    ASSERT_EQ(997u, sut.size());
+    ASSERT_TRUE(sut.find(3) == sut.end());
+    ASSERT_TRUE(sut.find(500) == sut.end());
+    ASSERT_EQ(999, *sut.rbegin());
+    ASSERT_TRUE(std::is_sorted(sut.begin(), sut.end()));
+}
+
+TEST(linear_set_should, build_in_parallel_like_sequential_build)
+{
+    std::vector<std::pair<int, int>> input;
+    for ( int i = 0; i < 200000; ++i )
+    {
+        input.push_back(std::make_pair((i * 7919) % 50021, i));
+    }
+    auto by_first = [](const std::pair<int, int>& lhs, const std::pair<int, int>& rhs)
+    {
+        return lhs.first < rhs.first;
+    };
+    typedef eos::linear_set<std::pair<int, int>, decltype(by_first)> set_type;
+    set_type expected(input.begin(), input.end(), by_first);
+    set_type sut = set_type::build_parallel(input.begin(), input.end(), 4, by_first);
+    ASSERT_EQ(expected.size(), sut.size());
+    ASSERT_TRUE(std::equal(expected.begin(), expected.end(), sut.begin()));
+}
+
+TEST(linear_set_should, look_up_batches_of_unsorted_keys)
+{
+    eos::linear_set<int> sut;
+    std::vector<int> queries;
+    for ( int i = 0; i < 1000; ++i )
+    {
+        sut.insert(3 * i);
+        queries.push_back((i * 7919) % 3100 - 50);
+    }
+    std::vector<eos::linear_set<int>::const_iterator> found(queries.size());
+    const eos::linear_set<int>& view = sut;
+    ASSERT_TRUE(view.find_many(queries.begin(), queries.end(), found.begin()) == found.end());
+    std::vector<std::uint64_t> mask((queries.size() + 63) / 64, ~std::uint64_t(0));
+    std::size_t present = 0;
+    for ( std::size_t i = 0; i < queries.size(); ++i )
+    {
+        ASSERT_TRUE(view.find(queries[i]) == found[i]);
+        present += view.count(queries[i]);
+    }
+    ASSERT_EQ(present, sut.contains_many(queries.begin(), queries.end(), mask.data()));
+    for ( std::size_t i = 0; i < queries.size(); ++i )
+    {
+        ASSERT_EQ(view.count(queries[i]), (mask[i / 64] >> (i % 64)) & 1);
+    }
+
+    eos::linear_set<int> empty;
+    ASSERT_EQ(0u, empty.contains_many(queries.begin(), queries.end(), mask.data()));
+    ASSERT_EQ(0u, mask[0]);
+}
+
+TEST(linear_set_should, grow_capacity_by_policy)
+{
+    eos::linear_set<int, std::less<int>, std::allocator<int>, eos::geometric_growth<5, 4> > geometric;
+    eos::linear_set<int, std::less<int>, std::allocator<int>, eos::fixed_growth<100> > fixed;
+    eos::linear_set<int, std::less<int>, std::allocator<int>, eos::exact_growth> exact;
+    geometric.reserve(1000);
+    fixed.reserve(1000);
+    for ( int i = 1000; i >= 0; --i )
+    {
+        geometric.insert(i);
+        fixed.insert(i);
+        exact.insert(i);
+        ASSERT_EQ(exact.size(), exact.capacity());
+    }
+    ASSERT_EQ(1250u, geometric.capacity());
+    ASSERT_EQ(1100u, fixed.capacity());
+
+    std::vector<int> batch = { 5000, 5001, 5002 };
+    exact.insert(batch.begin(), batch.end());
+    ASSERT_EQ(1004u, exact.capacity());
+    eos::erase_if(geometric, [](int key) { return key % 2 == 0; });
+    geometric.shrink_to_fit();
+    ASSERT_EQ(500u, geometric.capacity());
+    ASSERT_EQ(1u, geometric.count(999));
+}
+
+template <typename T>
+class linear_set_arithmetic_should : public ::testing::Test
+{
+};
+
+typedef ::testing::Types<std::int32_t, std::uint32_t, std::int64_t, std::uint64_t, float, double>
+    arithmetic_keys;
+TYPED_TEST_CASE(linear_set_arithmetic_should, arithmetic_keys);
+
+TYPED_TEST(linear_set_arithmetic_should, match_standard_lower_bound)
+{
+    for ( int size = 0; size < 300; size += 7 )
+    {
+        eos::linear_set<TypeParam> sut;
+        std::vector<TypeParam> expected;
+        for ( int i = 0; i < size; ++i )
+        {
+            sut.insert(static_cast<TypeParam>(3 * i + 1));
+            expected.push_back(static_cast<TypeParam>(3 * i + 1));
+        }
+        for ( int key = 0; key < 3 * size + 3; ++key )
+        {
+            TypeParam val = static_cast<TypeParam>(key);
+            ASSERT_EQ(std::lower_bound(expected.begin(), expected.end(), val) - expected.begin(),
+                      sut.lower_bound(val) - sut.begin());
+            ASSERT_EQ(std::binary_search(expected.begin(), expected.end(), val) ? 1u : 0u, sut.count(val));
+        }
+    }
+}
+
+TYPED_TEST(linear_set_arithmetic_should, match_standard_lower_bound_through_index)
+{
+    for ( int size = 0; size < 6000; size = size * 2 + 13 )
+    {
+        eos::linear_set<TypeParam> sut;
+        std::vector<TypeParam> expected;
+        for ( int i = 0; i < size; ++i )
+        {
+            sut.insert(static_cast<TypeParam>(3 * i + 1));
+            expected.push_back(static_cast<TypeParam>(3 * i + 1));
+        }
+        sut.build_index();
+        ASSERT_TRUE(sut.has_index());
+        for ( int key = 0; key < 3 * size + 3; ++key )
+        {
+            TypeParam val = static_cast<TypeParam>(key);
+            ASSERT_EQ(std::lower_bound(expected.begin(), expected.end(), val) - expected.begin(),
+                      sut.lower_bound(val) - sut.begin());
+            ASSERT_EQ(std::binary_search(expected.begin(), expected.end(), val) ? 1u : 0u, sut.count(val));
+        }
+    }
+}
+
+TEST(linear_set_should, drop_index_on_modification)
+{
+    eos::linear_set<int> sut = { 10, 20, 30 };
+    sut.build_index();
+    eos::linear_set<int> copy(sut);
+    ASSERT_TRUE(copy.has_index());
+    ASSERT_EQ(1, copy.lower_bound(15) - copy.begin());
+
+    ASSERT_FALSE(sut.insert(20).second);
+    ASSERT_TRUE(sut.has_index());
+    sut.insert(15);
+    ASSERT_FALSE(sut.has_index());
+    ASSERT_EQ(1u, sut.count(15));
+
+    sut.build_index();
+    sut.erase(10);
+    ASSERT_FALSE(sut.has_index());
+    ASSERT_EQ(0, sut.lower_bound(15) - sut.begin());
+
+    sut.swap(copy);
+    ASSERT_TRUE(sut.has_index());
+    ASSERT_FALSE(copy.has_index());
+    ASSERT_EQ(3, sut.lower_bound(31) - sut.begin());
+
+    eos::linear_set<int> moved(std::move(sut));
+    ASSERT_TRUE(moved.has_index());
+    ASSERT_FALSE(sut.has_index());
+    copy = moved;
+    ASSERT_TRUE(copy.has_index());
+    moved.clear();
+    ASSERT_EQ(2, copy.lower_bound(25) - copy.begin());
+}
+
 }  // namespace tests
 }  // namespace eos
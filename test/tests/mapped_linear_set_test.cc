@@ -0,0 +1,88 @@
+/**
+ * @author Gracjan Olbinski <gracjan.olbinski@gmail.com>
+ */
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <system_error>
+#include <sys/stat.h>
+#include "eos/linear_set.h"
+#include "eos/mapped_linear_set.h"
+
+namespace eos
+{
+namespace tests
+{
+
+TEST(mapped_linear_set_should, match_saved_linear_set)
+{
+    const char* path = "mapped_linear_set_test.bin";
+    for ( std::uint64_t size = 0; size < 300; size += 37 )
+    {
+        eos::linear_set<std::uint64_t> source;
+        for ( std::uint64_t i = 0; i < size; ++i )
+        {
+            source.insert(3 * i + 1);
+        }
+        source.save(path);
+
+        eos::mapped_linear_set<std::uint64_t> sut(path);
+        ASSERT_TRUE(sut.verify());
+        ASSERT_EQ(source.size(), sut.size());
+        ASSERT_TRUE(std::equal(source.begin(), source.end(), sut.begin()));
+        for ( std::uint64_t key = 0; key < 3 * size + 3; ++key )
+        {
+            ASSERT_EQ(std::distance(source.begin(), source.lower_bound(key)),
+                      std::distance(sut.begin(), sut.lower_bound(key)));
+            ASSERT_EQ(source.count(key), sut.count(key));
+        }
+    }
+    std::remove(path);
+}
+
+TEST(mapped_linear_set_should, reject_invalid_files)
+{
+    const char* path = "mapped_linear_set_test.bin";
+    ASSERT_THROW(eos::mapped_linear_set<int>("mapped_linear_set_test.missing"), std::system_error);
+
+    eos::linear_set<int> source = { 1, 2, 3 };
+    source.save(path);
+    ASSERT_THROW(eos::mapped_linear_set<long long>{ path }, std::runtime_error);
+    ASSERT_THROW(eos::mapped_linear_set<unsigned>{ path }, std::runtime_error);
+
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(64);
+        int value = 7;
+        file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+    eos::mapped_linear_set<int> corrupted(path);
+    ASSERT_FALSE(corrupted.verify());
+
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::app);
+        file.put('x');
+    }
+    ASSERT_THROW(eos::mapped_linear_set<int>{ path }, std::runtime_error);
+    std::remove(path);
+}
+
+TEST(mapped_linear_set_should, save_with_mode_filtered_by_umask)
+{
+    const char* path = "mapped_linear_set_test.bin";
+    eos::linear_set<int> source = { 1, 2, 3 };
+    mode_t previous = ::umask(027);
+    source.save(path);
+    ::umask(previous);
+
+    struct stat status;
+    ASSERT_EQ(0, ::stat(path, &status));
+    ASSERT_EQ(0640u, status.st_mode & 0777u);
+    ASSERT_EQ(3u, eos::mapped_linear_set<int>(path).size());
+    std::remove(path);
+}
+
+}  // namespace tests
+}  // namespace eos
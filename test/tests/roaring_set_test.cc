@@ -0,0 +1,124 @@
+/**
+ * @author Gracjan Olbinski <gracjan.olbinski@gmail.com>
+ */
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "eos/roaring_set.h"
+
+namespace eos
+{
+namespace tests
+{
+
+namespace
+{
+
+std::vector<std::uint32_t> clustered_keys(std::mt19937& random, std::size_t count)
+{
+    std::vector<std::uint32_t> keys;
+    while ( keys.size() < count )
+    {
+        std::uint32_t start = random() % (1u << 20), length = 1 + random() % ( random() % 2 ? 3 : 3000 );
+        for ( std::uint32_t i = 0; i < length; ++i )
+        {
+            keys.push_back(start + i * (1 + random() % 2));
+        }
+    }
+    return keys;
+}
+
+}  // namespace
+
+TEST(roaring_set_should, match_linear_set)
+{
+    std::mt19937 random(11);
+    for ( std::size_t count : { 0, 10, 5000, 200000 } )
+    {
+        std::vector<std::uint32_t> keys = clustered_keys(random, count);
+        eos::linear_set<std::uint32_t> source(keys.begin(), keys.end());
+        eos::roaring_set sut(keys.begin(), keys.end());
+        ASSERT_EQ(source.size(), sut.size());
+        ASSERT_TRUE(std::equal(source.begin(), source.end(), sut.begin()));
+        for ( std::size_t i = 0; i < 2000; ++i )
+        {
+            std::uint32_t key = random() % (1u << 20);
+            eos::linear_set<std::uint32_t>::iterator expected = source.lower_bound(key);
+            eos::roaring_set::const_iterator actual = sut.lower_bound(key);
+            ASSERT_EQ(expected == source.end(), actual == sut.end());
+            if ( expected != source.end() )
+            {
+                ASSERT_EQ(*expected, *actual);
+            }
+            ASSERT_EQ(source.count(key), sut.count(key));
+        }
+    }
+}
+
+TEST(roaring_set_should, insert_and_erase_across_container_kinds)
+{
+    std::mt19937 random(5);
+    eos::linear_set<std::uint32_t> source;
+    eos::roaring_set sut;
+    for ( std::size_t i = 0; i < 40000; ++i )
+    {
+        std::uint32_t key = ( i < 20000 ) ? random() % 70000 : (random() % 3) * 65536 + random() % 9000;
+        if ( random() % 4 == 0 )
+        {
+            ASSERT_EQ(source.erase(key), sut.erase(key));
+        }
+        else
+        {
+            ASSERT_EQ(source.insert(key).second, sut.insert(key).second);
+        }
+    }
+    ASSERT_EQ(source.size(), sut.size());
+    ASSERT_TRUE(std::equal(source.begin(), source.end(), sut.begin()));
+    for ( std::uint32_t key : source )
+    {
+        ASSERT_EQ(1u, sut.erase(key));
+    }
+    ASSERT_TRUE(sut.empty());
+    ASSERT_EQ(sut.end(), sut.begin());
+}
+
+TEST(roaring_set_should, unite_and_intersect_like_linear_set)
+{
+    std::mt19937 random(3);
+    for ( int round = 0; round < 10; ++round )
+    {
+        std::vector<std::uint32_t> left = clustered_keys(random, random() % 50000);
+        std::vector<std::uint32_t> right = clustered_keys(random, random() % 50000);
+        eos::linear_set<std::uint32_t> lhs(left.begin(), left.end()), rhs(right.begin(), right.end());
+        eos::roaring_set roaring_lhs(lhs), roaring_rhs(rhs);
+
+        eos::linear_set<std::uint32_t> expected = lhs | rhs;
+        eos::roaring_set actual = roaring_lhs | roaring_rhs;
+        ASSERT_EQ(expected.size(), actual.size());
+        ASSERT_TRUE(std::equal(expected.begin(), expected.end(), actual.begin()));
+
+        expected = lhs & rhs;
+        actual = roaring_lhs & roaring_rhs;
+        ASSERT_EQ(expected.size(), actual.size());
+        ASSERT_TRUE(std::equal(expected.begin(), expected.end(), actual.begin()));
+    }
+}
+
+TEST(roaring_set_should, compress_dense_ranges)
+{
+    std::vector<std::uint32_t> keys;
+    for ( std::uint32_t i = 0; i < 1000000; ++i )
+    {
+        keys.push_back(( i < 500000 ) ? i : 4 * i);
+    }
+    eos::roaring_set sut(keys.begin(), keys.end());
+    ASSERT_LT(sut.memory_usage() * 10, keys.size() * sizeof(std::uint32_t));
+    ASSERT_EQ(3u, *sut.find(3));
+    ASSERT_EQ(sut.end(), sut.find(2000001));
+    ASSERT_EQ(2000000u, *sut.upper_bound(499999));
+}
+
+}  // namespace tests
+}  // namespace eos
@@ -0,0 +1,125 @@
+/**
+ * @author Gracjan Olbinski <gracjan.olbinski@gmail.com>
+ */
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "eos/sharded_linear_set.h"
+
+namespace eos
+{
+namespace tests
+{
+
+TEST(sharded_linear_set_should, keep_keys_ordered_across_concurrent_writers)
+{
+    eos::sharded_linear_set<int, 8> sut;
+    std::vector<std::thread> writers;
+    for ( int w = 0; w < 4; ++w )
+    {
+        writers.push_back(std::thread([&sut, w]
+        {
+            for ( int i = w; i < 40000; i += 4 )
+            {
+                sut.insert(( i * 7919 ) % 40000);
+            }
+        }));
+    }
+    for ( std::size_t i = 0; i < writers.size(); ++i )
+    {
+        writers[i].join();
+    }
+    ASSERT_EQ(40000u, sut.size());
+    for ( std::size_t i = 0; i < sut.shard_count(); ++i )
+    {
+        ASSERT_GT(sut.shard_size(i), 0u);
+    }
+
+    int expected = 0;
+    bool ordered = true;
+    sut.for_each([&](int key)
+    {
+        ordered = ordered && key == expected++;
+    });
+    ASSERT_TRUE(ordered);
+    ASSERT_EQ(40000, expected);
+}
+
+TEST(sharded_linear_set_should, route_lookups_after_rebalance)
+{
+    eos::sharded_linear_set<int, 4> sut(std::vector<int>({ 100, 200, 300 }));
+    std::vector<int> batch;
+    for ( int i = 0; i < 1000; i += 2 )
+    {
+        batch.push_back(i);
+    }
+    sut.insert(batch.begin(), batch.end());
+    ASSERT_EQ(50u, sut.shard_size(0));
+    ASSERT_EQ(350u, sut.shard_size(3));
+    ASSERT_FALSE(sut.insert(300));
+
+    sut.rebalance();
+    ASSERT_EQ(125u, sut.shard_size(0));
+    ASSERT_EQ(125u, sut.shard_size(3));
+    ASSERT_EQ(1u, sut.count(998));
+    ASSERT_EQ(0u, sut.count(999));
+    ASSERT_EQ(1u, sut.erase(250));
+    ASSERT_EQ(0u, sut.erase(250));
+
+    eos::linear_set<int> snapshot = sut.snapshot();
+    ASSERT_EQ(499u, snapshot.size());
+    ASSERT_EQ(0, *snapshot.begin());
+    ASSERT_EQ(998, *snapshot.rbegin());
+    ASSERT_EQ(0u, snapshot.count(250));
+}
+
+TEST(sharded_linear_set_should, rebalance_after_skewed_bulk_load)
+{
+    eos::sharded_linear_set<int, 4> sut;
+    std::vector<int> batch;
+    for ( int i = 0; i < 5000; ++i )
+    {
+        batch.push_back(i);
+    }
+    sut.insert(batch.begin(), batch.end());
+    for ( std::size_t i = 0; i < sut.shard_count(); ++i )
+    {
+        ASSERT_EQ(1250u, sut.shard_size(i));
+    }
+}
+
+TEST(sharded_linear_set_should, free_superseded_splitters)
+{
+    eos::sharded_linear_set<int, 4> sut;
+    for ( int i = 0; i < 1000; ++i )
+    {
+        sut.insert(i);
+    }
+    std::atomic<bool> done(false);
+    std::atomic<bool> found(true);
+    std::thread reader([&]
+    {
+        while ( !done.load() )
+        {
+            for ( int i = 0; i < 1000; i += 37 )
+            {
+                found = found && sut.count(i) == 1;
+            }
+        }
+    });
+    for ( int round = 0; round < 50; ++round )
+    {
+        sut.insert(1000 + round);
+        sut.rebalance();
+    }
+    done = true;
+    reader.join();
+    ASSERT_TRUE(found.load());
+    ASSERT_EQ(0u, sut.retired());
+    ASSERT_EQ(1050u, sut.size());
+}
+
+}  // namespace tests
+}  // namespace eos
@@ -0,0 +1,39 @@
+/**
+ * @author Gracjan Olbinski <gracjan.olbinski@gmail.com>
+ */
+
+#include <gtest/gtest.h>
+#include <string>
+#include "eos/small_linear_set.h"
+
+namespace eos
+{
+namespace tests
+{
+
+TEST(small_linear_set_should, behave_like_linear_set_across_spill)
+{
+    eos::small_linear_set<std::string, 4> sut{"delta", "alpha", "charlie"};
+    sut.insert("bravo");
+    sut.insert("alpha");
+    sut.emplace("echo");
+    ASSERT_EQ(5u, sut.size());
+    ASSERT_EQ(std::vector<std::string>({"alpha", "bravo", "charlie", "delta", "echo"}),
+              std::vector<std::string>(sut.begin(), sut.end()));
+    ASSERT_EQ(1u, sut.erase("charlie"));
+    ASSERT_TRUE(sut.find("charlie") == sut.end());
+    ASSERT_EQ("delta", *sut.find("delta"));
+}
+
+TEST(small_linear_set_should, copy_and_swap)
+{
+    eos::small_linear_set<int, 8> first{3, 1, 2};
+    eos::small_linear_set<int, 8> second(first);
+    second.insert(0);
+    first.swap(second);
+    ASSERT_EQ(std::vector<int>({0, 1, 2, 3}), std::vector<int>(first.begin(), first.end()));
+    ASSERT_EQ(std::vector<int>({1, 2, 3}), std::vector<int>(second.begin(), second.end()));
+}
+
+}  // namespace tests
+}  // namespace eos
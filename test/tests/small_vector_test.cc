@@ -0,0 +1,145 @@
+/**
+ * @author Gracjan Olbinski <gracjan.olbinski@gmail.com>
+ */
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "eos/small_vector.h"
+
+namespace eos
+{
+namespace tests
+{
+
+namespace
+{
+
+/**
+ * Stateful allocator whose moved-from instances compare unequal to every
+ * other, as a stateful allocator is allowed to.
+ */
+template <class T>
+struct tagged_allocator
+{
+    typedef T               value_type;
+    typedef std::true_type  propagate_on_container_move_assignment;
+
+    template <class U>
+    struct rebind
+    {
+        typedef tagged_allocator<U> other;
+    };
+
+    explicit tagged_allocator(int tag)
+    : tag(tag)
+    {
+    }
+
+    template <class U>
+    tagged_allocator(const tagged_allocator<U>& other)
+    : tag(other.tag)
+    {
+    }
+
+    tagged_allocator(const tagged_allocator& other) = default;
+
+    tagged_allocator(tagged_allocator&& other)
+    : tag(other.tag)
+    {
+        other.tag = -1;
+    }
+
+    tagged_allocator& operator=(const tagged_allocator& other) = default;
+
+    tagged_allocator& operator=(tagged_allocator&& other)
+    {
+        tag = other.tag;
+        other.tag = -1;
+        return *this;
+    }
+
+    T* allocate(std::size_t n)
+    {
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n)
+    {
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    bool operator==(const tagged_allocator& other) const
+    {
+        return tag == other.tag;
+    }
+
+    bool operator!=(const tagged_allocator& other) const
+    {
+        return tag != other.tag;
+    }
+
+    int tag;
+};
+
+static_assert(std::is_nothrow_move_constructible<eos::small_vector<int, 4> >::value,
+              "small_vector<int, 4> should be nothrow move constructible");
+
+}  // namespace
+
+TEST(small_vector_should, keep_elements_inline_up_to_capacity)
+{
+    eos::small_vector<int, 4> sut{1, 2, 3, 4};
+    ASSERT_TRUE(sut.is_inline());
+    sut.push_back(5);
+    ASSERT_FALSE(sut.is_inline());
+    ASSERT_EQ(std::vector<int>({1, 2, 3, 4, 5}), std::vector<int>(sut.begin(), sut.end()));
+}
+
+TEST(small_vector_should, move_back_inline_on_shrink_to_fit)
+{
+    eos::small_vector<std::string, 2> sut{"a", "b", "c"};
+    sut.erase(sut.begin());
+    sut.shrink_to_fit();
+    ASSERT_TRUE(sut.is_inline());
+    ASSERT_EQ(std::vector<std::string>({"b", "c"}), std::vector<std::string>(sut.begin(), sut.end()));
+}
+
+TEST(small_vector_should, insert_and_erase_in_the_middle)
+{
+    eos::small_vector<std::string, 2> sut{"a", "d"};
+    sut.insert(sut.begin() + 1, std::string("c"));
+    sut.emplace(sut.begin() + 1, "b");
+    ASSERT_EQ(std::vector<std::string>({"a", "b", "c", "d"}), std::vector<std::string>(sut.begin(), sut.end()));
+    sut.erase(sut.begin() + 1, sut.begin() + 3);
+    ASSERT_EQ(std::vector<std::string>({"a", "d"}), std::vector<std::string>(sut.begin(), sut.end()));
+}
+
+TEST(small_vector_should, swap_inline_and_heap_contents)
+{
+    eos::small_vector<std::string, 2> inline_sut{"x"};
+    eos::small_vector<std::string, 2> heap_sut{"a", "b", "c"};
+    inline_sut.swap(heap_sut);
+    ASSERT_EQ(std::vector<std::string>({"a", "b", "c"}), std::vector<std::string>(inline_sut.begin(), inline_sut.end()));
+    ASSERT_EQ(std::vector<std::string>({"x"}), std::vector<std::string>(heap_sut.begin(), heap_sut.end()));
+}
+
+TEST(small_vector_should, steal_heap_buffer_on_move_with_stateful_allocator)
+{
+    typedef eos::small_vector<int, 2, tagged_allocator<int> > vector_type;
+    vector_type source({ 1, 2, 3 }, tagged_allocator<int>(1));
+    const int* buffer = &*source.begin();
+    vector_type moved(std::move(source));
+    ASSERT_EQ(buffer, &*moved.begin());
+
+    vector_type target(tagged_allocator<int>(2));
+    target = std::move(moved);
+    ASSERT_EQ(buffer, &*target.begin());
+    ASSERT_EQ(1, target.get_allocator().tag);
+    ASSERT_EQ(std::vector<int>({ 1, 2, 3 }), std::vector<int>(target.begin(), target.end()));
+}
+
+}  // namespace tests
+}  // namespace eos
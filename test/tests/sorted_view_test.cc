@@ -0,0 +1,71 @@
+/**
+ * @author Gracjan Olbinski <gracjan.olbinski@gmail.com>
+ */
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "eos/linear_set.h"
+#include "eos/sorted_view.h"
+
+namespace eos
+{
+namespace tests
+{
+
+namespace
+{
+
+struct c_string_less
+{
+    typedef void is_transparent;
+
+    bool operator()(const std::string& lhs, const std::string& rhs) const
+    {
+        return lhs < rhs;
+    }
+
+    bool operator()(const std::string& lhs, const char* rhs) const
+    {
+        return lhs.compare(rhs) < 0;
+    }
+
+    bool operator()(const char* lhs, const std::string& rhs) const
+    {
+        return rhs.compare(lhs) > 0;
+    }
+};
+
+}  // namespace
+
+TEST(sorted_view_should, search_external_memory_in_place)
+{
+    const int keys[] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29 };
+    eos::sorted_view<int> sut(keys, sizeof(keys) / sizeof(keys[0]));
+    ASSERT_EQ(10u, sut.size());
+    ASSERT_EQ(keys, sut.data());
+    for ( int key = 0; key < 32; ++key )
+    {
+        ASSERT_EQ(std::lower_bound(keys, keys + 10, key), sut.lower_bound(key));
+        ASSERT_EQ(std::upper_bound(keys, keys + 10, key), sut.upper_bound(key));
+        ASSERT_EQ(std::binary_search(keys, keys + 10, key) ? 1u : 0u, sut.count(key));
+    }
+    ASSERT_EQ(keys + 4, sut.find(11));
+    ASSERT_EQ(sut.end(), sut.find(12));
+    ASSERT_TRUE(eos::sorted_view<int>().empty());
+}
+
+TEST(sorted_view_should, view_linear_set_without_copying)
+{
+    eos::linear_set<std::string, c_string_less> source = { "pear", "apple", "fig", "kiwi" };
+    eos::sorted_view<std::string, c_string_less> sut = source.view();
+    ASSERT_EQ(&*source.begin(), sut.data());
+    ASSERT_TRUE(std::equal(source.begin(), source.end(), sut.begin()));
+    ASSERT_EQ("kiwi", *sut.find("kiwi"));
+    ASSERT_EQ(1u, sut.count("fig"));
+    ASSERT_EQ(sut.begin() + 2, sut.equal_range("kiwi").first);
+    ASSERT_EQ(sut.end(), sut.find("plum"));
+}
+
+}  // namespace tests
+}  // namespace eos